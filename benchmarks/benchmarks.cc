@@ -1,35 +1,437 @@
 #include <algorithm>
 #include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstddef>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <hdrbg.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
-#define benchmark(function, iterations)                                                                               \
-    do                                                                                                                \
-    {                                                                                                                 \
-        auto delay = std::chrono::microseconds::max();                                                                \
-        for (int i = 0; i < 32; ++i)                                                                                  \
-        {                                                                                                             \
-            auto begin = std::chrono::high_resolution_clock::now();                                                   \
-            for (int i = 0; i < iterations; ++i)                                                                      \
-            {                                                                                                         \
-                function(0);                                                                                          \
-            }                                                                                                         \
-            auto end = std::chrono::high_resolution_clock::now();                                                     \
-            auto delay_ = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);                         \
-            delay = std::min(delay, delay_);                                                                          \
-        }                                                                                                             \
-        auto result = delay.count() / static_cast<double>(iterations);                                                \
-        std::printf("%20s %8.2lf µs\n", #function, result);                                                           \
-    } while (false)
+#if defined __x86_64__ || defined __i386__
+#include <x86intrin.h>
+#define BENCHMARK_CYCLES 1
+#endif
+
+#if defined __linux__
+#include <sys/random.h>
+#define BENCHMARK_GETRANDOM 1
+#endif
+
+#ifdef BENCHMARK_OPENSSL
+#include <openssl/rand.h>
+#endif
+
+/******************************************************************************
+ * Timing of one benchmark, as the minimum over all passes.
+ *****************************************************************************/
+struct result_t
+{
+    std::string group;
+    std::string name;
+    std::size_t bytes;    // Bytes generated per iteration (0 if not applicable).
+    int unsigned threads; // Number of threads which ran concurrently.
+    double ns;            // Nanoseconds per iteration.
+    double cycles;        // Time-stamp counter cycles per iteration (negative if unavailable).
+};
+
+static int passes = 16;
+static std::vector<result_t> results;
+
+/******************************************************************************
+ * Read the time-stamp counter, if there is one.
+ *
+ * @return Counter value, or 0.
+ *****************************************************************************/
+static std::uint64_t
+cycles_now(void)
+{
+#ifdef BENCHMARK_CYCLES
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/******************************************************************************
+ * Run a function repeatedly, and record the smallest time taken by it.
+ *
+ * @param group Benchmark group.
+ * @param name Benchmark name.
+ * @param bytes Number of bytes generated per call.
+ * @param iterations Number of calls per pass.
+ * @param function Function to run.
+ *****************************************************************************/
+static void
+measure(char const *group, std::string const &name, std::size_t bytes, long iterations,
+    std::function<void(void)> const &function)
+{
+    double ns = HUGE_VAL;
+    double cycles = HUGE_VAL;
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        std::uint64_t c_begin = cycles_now();
+        for (long i = 0; i < iterations; ++i)
+        {
+            function();
+        }
+        std::uint64_t c_end = cycles_now();
+        auto end = std::chrono::steady_clock::now();
+        ns = std::min(ns, std::chrono::duration<double, std::nano>(end - begin).count() / iterations);
+        cycles = std::min(cycles, static_cast<double>(c_end - c_begin) / iterations);
+    }
+#ifndef BENCHMARK_CYCLES
+    cycles = -1;
+#endif
+    results.push_back({ group, name, bytes, 1, ns, cycles });
+}
+
+/******************************************************************************
+ * Number of calls to make in each pass so that about 1 MiB is generated.
+ *
+ * @param bytes Number of bytes generated per call.
+ *
+ * @return Number of calls.
+ *****************************************************************************/
+static long
+iterations_for(std::size_t bytes)
+{
+    return std::max(1L, std::min(16384L, static_cast<long>((1UL << 20) / bytes)));
+}
+
+/******************************************************************************
+ * Check for errors after a benchmark. There is no point in continuing if the
+ * generator failed, because the timings would be meaningless.
+ *
+ * @param name Benchmark name.
+ *****************************************************************************/
+static void
+check(char const *name)
+{
+    enum hdrbg_err_t err = hdrbg_err_get();
+    if (err != HDRBG_ERR_NONE)
+    {
+        std::fprintf(stderr, "%s: error %d\n", name, static_cast<int>(err));
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+static void
+benchmark_lifecycle(void)
+{
+    measure("lifecycle", "hdrbg_init", 0, 100, [] { hdrbg_init(false); });
+    measure("lifecycle", "hdrbg_reinit", 0, 100, [] { hdrbg_reinit(NULL); });
+
+    // Creating and reseeding many HDRBG objects, one at a time and in bulk.
+    hdrbg_t *hds[64];
+    measure("lifecycle", "init_x64", 0, 10,
+        [&hds]
+        {
+            for (hdrbg_t *&hd : hds)
+            {
+                hd = hdrbg_init(true);
+            }
+            for (hdrbg_t *hd : hds)
+            {
+                hdrbg_zero(hd);
+            }
+        });
+    measure("lifecycle", "init_many_x64", 0, 10,
+        [&hds]
+        {
+            hdrbg_init_many(hds, 64);
+            for (hdrbg_t *hd : hds)
+            {
+                hdrbg_zero(hd);
+            }
+        });
+    hdrbg_init_many(hds, 64);
+    measure("lifecycle", "reinit_x64", 0, 10,
+        [&hds]
+        {
+            for (hdrbg_t *hd : hds)
+            {
+                hdrbg_reinit(hd);
+            }
+        });
+    measure("lifecycle", "reinit_many_x64", 0, 10, [&hds] { hdrbg_reinit_many(hds, 64); });
+    for (hdrbg_t *hd : hds)
+    {
+        hdrbg_zero(hd);
+    }
+    check("lifecycle");
+}
+
+static void
+benchmark_fill(void)
+{
+    static std::uint8_t r_bytes[65536];
+    for (std::size_t r_length = 1; r_length <= 65536; r_length *= 4)
+    {
+        measure("fill", "hdrbg_fill", r_length, iterations_for(r_length),
+            [r_length] { hdrbg_fill(NULL, false, r_bytes, r_length); });
+    }
+    check("fill");
+}
+
+static void
+benchmark_fill_sha512(void)
+{
+    static std::uint8_t r_bytes[65536];
+    hdrbg_t *hd = hdrbg_init_ex(HDRBG_HASH_SHA512);
+    check("fill_sha512");
+    for (std::size_t r_length = 1; r_length <= 65536; r_length *= 4)
+    {
+        measure("fill_sha512", "hdrbg_fill", r_length, iterations_for(r_length),
+            [hd, r_length] { hdrbg_fill(hd, false, r_bytes, r_length); });
+    }
+    check("fill_sha512");
+    hdrbg_zero(hd);
+}
+
+static void
+benchmark_prediction_resistance(void)
+{
+    static std::uint8_t r_bytes[65536];
+    for (std::size_t r_length : { 64UL, 65536UL })
+    {
+        measure("prediction_resistance", "hdrbg_fill(false)", r_length, iterations_for(r_length) / 16 + 1,
+            [r_length] { hdrbg_fill(NULL, false, r_bytes, r_length); });
+        measure("prediction_resistance", "hdrbg_fill(true)", r_length, iterations_for(r_length) / 16 + 1,
+            [r_length] { hdrbg_fill(NULL, true, r_bytes, r_length); });
+    }
+    check("prediction_resistance");
+}
+
+static void
+benchmark_scalar(void)
+{
+    // Accumulate the results so that the calls cannot be optimised away.
+    static std::uint64_t volatile sink;
+    long iterations = 4096;
+
+    // The internal HDRBG object does not buffer its output, so compare it
+    // with an HDRBG object which does.
+    hdrbg_t *buffered = hdrbg_init(true);
+    check("scalar_buffered");
+    hdrbg_buffer(buffered, true);
+    for (auto [group, hd] : { std::pair<char const *, hdrbg_t *>{ "scalar", NULL }, { "scalar_buffered", buffered } })
+    {
+        measure(group, "hdrbg_rand", 8, iterations, [hd = hd] { sink = sink + hdrbg_rand(hd); });
+        measure(group, "hdrbg_uint", 8, iterations, [hd = hd] { sink = sink + hdrbg_uint(hd, 1000003); });
+        measure(group, "hdrbg_uint32", 4, iterations, [hd = hd] { sink = sink + hdrbg_uint32(hd, 1000003); });
+        measure(group, "hdrbg_span", 8, iterations, [hd = hd] { sink = sink + hdrbg_span(hd, -1000, 1000); });
+        measure(group, "hdrbg_real", 8, iterations, [hd = hd] { sink = sink + (hdrbg_real(hd) < 0.5L); });
+        measure(group, "hdrbg_double", 8, iterations, [hd = hd] { sink = sink + (hdrbg_double(hd) < 0.5); });
+        measure(
+            group, "hdrbg_double_open", 8, iterations, [hd = hd] { sink = sink + (hdrbg_double_open(hd) < 0.5); });
+        measure(group, "hdrbg_float", 4, iterations, [hd = hd] { sink = sink + (hdrbg_float(hd) < 0.5F); });
+        check(group);
+    }
+    hdrbg_zero(buffered);
+
+    static std::uint64_t r[1024];
+    static std::int64_t s[1024];
+    static double d[1024];
+    iterations = 64;
+    measure("array", "hdrbg_rand_array", sizeof r, iterations, [] { hdrbg_rand_array(NULL, r, 1024); });
+    measure("array", "hdrbg_uint_array", sizeof r, iterations, [] { hdrbg_uint_array(NULL, 1000003, r, 1024); });
+    measure("array", "hdrbg_span_array", sizeof s, iterations, [] { hdrbg_span_array(NULL, -1000, 1000, s, 1024); });
+    measure("array", "hdrbg_real_array", sizeof d, iterations, [] { hdrbg_real_array(NULL, d, 1024); });
+    check("array");
+}
+
+/******************************************************************************
+ * Measure the total throughput of several threads, each of which fills its own
+ * buffer using its own HDRBG object.
+ *
+ * @param max_threads Largest number of threads to try.
+ *****************************************************************************/
+static void
+benchmark_scaling(int unsigned max_threads)
+{
+    constexpr std::size_t r_length = 65536;
+    constexpr long iterations = 64;
+    for (int unsigned threads = 1; threads <= max_threads; ++threads)
+    {
+        std::vector<hdrbg_t *> hds(threads);
+        for (hdrbg_t *&hd : hds)
+        {
+            hd = hdrbg_init(true);
+        }
+        check("scaling");
+        double ns = HUGE_VAL;
+        for (int pass = 0; pass < passes; ++pass)
+        {
+            std::vector<std::thread> workers;
+            auto begin = std::chrono::steady_clock::now();
+            for (hdrbg_t *hd : hds)
+            {
+                workers.emplace_back([hd] {
+                    std::vector<std::uint8_t> r_bytes(r_length);
+                    for (long i = 0; i < iterations; ++i)
+                    {
+                        hdrbg_fill(hd, false, r_bytes.data(), r_length);
+                    }
+                });
+            }
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+            auto end = std::chrono::steady_clock::now();
+            ns = std::min(ns, std::chrono::duration<double, std::nano>(end - begin).count() / iterations);
+        }
+        for (hdrbg_t *hd : hds)
+        {
+            hdrbg_zero(hd);
+        }
+
+        // Each iteration generates one request's worth of bytes per thread.
+        results.push_back({ "scaling", "hdrbg_fill", r_length * threads, threads, ns, -1 });
+    }
+}
+
+static void
+benchmark_baselines(void)
+{
+    static std::uint8_t r_bytes[65536];
+#ifdef BENCHMARK_GETRANDOM
+    for (std::size_t r_length : { 64UL, 65536UL })
+    {
+        measure("baseline", "getrandom", r_length, iterations_for(r_length) / 16 + 1, [r_length] {
+            for (std::size_t done = 0; done < r_length;)
+            {
+                ssize_t count = getrandom(r_bytes + done, r_length - done, 0);
+                done += count > 0 ? count : 0;
+            }
+        });
+    }
+#endif
+#ifdef BENCHMARK_OPENSSL
+    for (std::size_t r_length : { 64UL, 65536UL })
+    {
+        measure("baseline", "RAND_bytes", r_length, iterations_for(r_length),
+            [r_length] { RAND_bytes(r_bytes, static_cast<int>(r_length)); });
+    }
+#endif
+    static_cast<void>(r_bytes);
+}
+
+/******************************************************************************
+ * Display the results as a table.
+ *****************************************************************************/
+static void
+print_table(void)
+{
+    std::printf("%-22s %-18s %8s %7s %12s %12s %10s\n", "Group", "Name", "Bytes", "Threads", "ns/call", "MB/s",
+        "cycles/B");
+    for (result_t const &result : results)
+    {
+        std::printf("%-22s %-18s %8zu %7u %12.1f", result.group.c_str(), result.name.c_str(), result.bytes,
+            result.threads, result.ns);
+        if (result.bytes > 0)
+        {
+            std::printf(" %12.1f", result.bytes * 1e3 / result.ns);
+        }
+        else
+        {
+            std::printf(" %12s", "-");
+        }
+        if (result.bytes > 0 && result.cycles >= 0)
+        {
+            std::printf(" %10.2f\n", result.cycles / result.bytes);
+        }
+        else
+        {
+            std::printf(" %10s\n", "-");
+        }
+    }
+}
+
+/******************************************************************************
+ * Display the results as JSON. Throughput is in bytes per second, and is null
+ * where it is not applicable, as is the cycle count.
+ *****************************************************************************/
+static void
+print_json(void)
+{
+    std::printf("{\"backend\": \"%s\", \"passes\": %d, \"results\": [", hdrbg_backend(), passes);
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        result_t const &result = results[i];
+        std::printf("%s\n  {\"group\": \"%s\", \"name\": \"%s\", \"bytes\": %zu, \"threads\": %u, \"ns\": %.3f",
+            i == 0 ? "" : ",", result.group.c_str(), result.name.c_str(), result.bytes, result.threads, result.ns);
+        if (result.bytes > 0)
+        {
+            std::printf(", \"bytes_per_second\": %.0f", result.bytes * 1e9 / result.ns);
+        }
+        else
+        {
+            std::printf(", \"bytes_per_second\": null");
+        }
+        if (result.bytes > 0 && result.cycles >= 0)
+        {
+            std::printf(", \"cycles_per_byte\": %.4f}", result.cycles / result.bytes);
+        }
+        else
+        {
+            std::printf(", \"cycles_per_byte\": null}");
+        }
+    }
+    std::printf("\n]}\n");
+}
 
 /******************************************************************************
  * Main function.
+ *
+ * Usage: benchmarks [--json] [--passes N] [--threads N]
  *****************************************************************************/
 int
-main(void)
+main(int const argc, char const *argv[])
 {
-    benchmark(hdrbg_init, 100);
-    benchmark(hdrbg_reinit, 100);
-    benchmark(hdrbg_rand, 800);
-    benchmark(hdrbg_real, 800);
+    bool json = false;
+    int unsigned max_threads = std::max(1U, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else if (std::strcmp(argv[i], "--passes") == 0 && i + 1 < argc)
+        {
+            passes = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            max_threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--json] [--passes N] [--threads N]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    benchmark_lifecycle();
+    benchmark_fill();
+    benchmark_fill_sha512();
+    benchmark_prediction_resistance();
+    benchmark_scalar();
+    benchmark_scaling(max_threads);
+    benchmark_baselines();
+    if (json)
+    {
+        print_json();
+    }
+    else
+    {
+        print_table();
+    }
 }
@@ -0,0 +1,29 @@
+#include <algorithm>
+#include <cinttypes>
+#include <hdrbg.hpp>
+#include <iostream>
+#include <random>
+#include <span>
+#include <vector>
+
+int
+main(void)
+{
+    hdrbg::engine eng;
+    std::uint8_t r_bytes[64];
+    eng.fill(std::span(r_bytes));
+    hdrbg_dump(r_bytes, 64);
+
+    std::uniform_int_distribution<int> dist(1, 6);
+    for (int i = 0; i < 4; ++i)
+    {
+        std::cout << dist(eng) << ' ';
+    }
+    std::vector<int> v{1, 2, 3, 4, 5, 6, 7, 8};
+    std::shuffle(v.begin(), v.end(), eng);
+    for (int x : v)
+    {
+        std::cout << x << ' ';
+    }
+    std::cout << '\n';
+}
@@ -0,0 +1,9 @@
+#ifndef TFPF_HASH_DRBG_INCLUDE_ENTROPY_H_
+#define TFPF_HASH_DRBG_INCLUDE_ENTROPY_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+
+size_t entropy_os(uint8_t *e_bytes, size_t e_length);
+
+#endif  // TFPF_HASH_DRBG_INCLUDE_ENTROPY_H_
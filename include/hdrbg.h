@@ -5,6 +5,7 @@
 #include <cinttypes>
 #include <cstddef>
 #define uint8_t std::uint8_t
+#define uint32_t std::uint32_t
 #define uint64_t std::uint64_t
 #define size_t std::size_t
 #define int64_t std::int64_t
@@ -15,6 +16,8 @@
 #endif
 
 struct hdrbg_t;
+struct iovec;
+struct hdrbg_pool_t;
 enum hdrbg_err_t
 {
     HDRBG_ERR_NONE,
@@ -24,6 +27,43 @@ enum hdrbg_err_t
     HDRBG_ERR_INVALID_REQUEST_FILL,
     HDRBG_ERR_INVALID_REQUEST_UINT,
     HDRBG_ERR_INVALID_REQUEST_SPAN,
+    HDRBG_ERR_POOL_EMPTY,
+    HDRBG_ERR_NO_THREADS,
+    HDRBG_ERR_NO_STATS,
+    HDRBG_ERR_INVALID_HASH,
+};
+
+enum hdrbg_hash_t
+{
+    HDRBG_HASH_SHA256,
+    HDRBG_HASH_SHA512,
+};
+
+struct hdrbg_prefetch_stats_t
+{
+    size_t depth;
+    size_t available;
+    uint64_t refills;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+struct hdrbg_counters_t
+{
+    uint64_t requests;
+    uint64_t bytes;
+    uint64_t reseeds_interval;
+    uint64_t reseeds_prediction_resistance;
+    uint64_t reseeds_explicit;
+    uint64_t reseeds_fork;
+    uint64_t entropy_reads;
+    uint64_t entropy_ns;
+};
+
+struct hdrbg_stats_t
+{
+    struct hdrbg_counters_t object;
+    struct hdrbg_counters_t process;
 };
 
 #ifdef __cplusplus
@@ -31,15 +71,41 @@ extern "C"
 {
 #endif
     enum hdrbg_err_t hdrbg_err_get(void);
+    char const *hdrbg_backend(void);
+    void hdrbg_set_entropy_source(size_t (*source)(void *ctx, uint8_t *e_bytes, size_t e_length), void *ctx);
+    int hdrbg_prefetch_start(size_t depth);
+    void hdrbg_prefetch_stop(void);
+    void hdrbg_prefetch_stats(struct hdrbg_prefetch_stats_t *stats);
     struct hdrbg_t *hdrbg_init(bool dma);
+    struct hdrbg_t *hdrbg_init_ex(enum hdrbg_hash_t hash);
+    int hdrbg_init_many(struct hdrbg_t **hds, size_t count);
     struct hdrbg_t *hdrbg_reinit(struct hdrbg_t *hd);
+    int hdrbg_reinit_many(struct hdrbg_t **hds, size_t count);
     int hdrbg_fill(struct hdrbg_t *hd, bool prediction_resistance, uint8_t *r_bytes, int long unsigned r_length);
+    int hdrbg_fillv(struct hdrbg_t *hd, bool prediction_resistance, struct iovec const *iov, int iov_count);
+    int hdrbg_fill_stream(struct hdrbg_t *hd, bool prediction_resistance, uint8_t *r_bytes, size_t r_length);
+    int hdrbg_fill_parallel(struct hdrbg_t *hd, bool prediction_resistance, uint8_t *r_bytes, size_t r_length,
+        int unsigned threads);
+    void hdrbg_buffer(struct hdrbg_t *hd, bool buffered);
     uint64_t hdrbg_rand(struct hdrbg_t *hd);
     uint64_t hdrbg_uint(struct hdrbg_t *hd, uint64_t modulus);
+    uint32_t hdrbg_uint32(struct hdrbg_t *hd, uint32_t modulus);
     int64_t hdrbg_span(struct hdrbg_t *hd, int64_t left, int64_t right);
     double long hdrbg_real(struct hdrbg_t *hd);
+    double hdrbg_double(struct hdrbg_t *hd);
+    double hdrbg_double_open(struct hdrbg_t *hd);
+    float hdrbg_float(struct hdrbg_t *hd);
+    int hdrbg_rand_array(struct hdrbg_t *hd, uint64_t *r, size_t r_length);
+    int hdrbg_uint_array(struct hdrbg_t *hd, uint64_t modulus, uint64_t *r, size_t r_length);
+    int hdrbg_span_array(struct hdrbg_t *hd, int64_t left, int64_t right, int64_t *r, size_t r_length);
+    int hdrbg_real_array(struct hdrbg_t *hd, double *r, size_t r_length);
     int hdrbg_drop(struct hdrbg_t *hd, int long long count);
     void hdrbg_zero(struct hdrbg_t *hd);
+    int hdrbg_stats_get(struct hdrbg_t *hd, struct hdrbg_stats_t *stats);
+    struct hdrbg_pool_t *hdrbg_pool_create(size_t count);
+    struct hdrbg_t *hdrbg_pool_acquire(struct hdrbg_pool_t *pool);
+    void hdrbg_pool_release(struct hdrbg_pool_t *pool, struct hdrbg_t *hd);
+    void hdrbg_pool_zero(struct hdrbg_pool_t *pool);
     void hdrbg_dump(uint8_t const *m_bytes, size_t m_length);
     void hdrbg_tests(struct hdrbg_t *hd, void *tv);
 #ifdef __cplusplus
@@ -48,6 +114,7 @@ extern "C"
 
 #ifdef __cplusplus
 #undef uint8_t
+#undef uint32_t
 #undef uint64_t
 #undef size_t
 #undef int64_t
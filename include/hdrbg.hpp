@@ -0,0 +1,205 @@
+#ifndef TFPF_HASH_DRBG_INCLUDE_HDRBG_HPP_
+#define TFPF_HASH_DRBG_INCLUDE_HDRBG_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#include <hdrbg.h>
+
+namespace hdrbg
+{
+/******************************************************************************
+ * Exception thrown when a function of the C API fails. It carries the error
+ * indicator which the failing function set.
+ *****************************************************************************/
+class error : public std::runtime_error
+{
+public:
+    explicit error(hdrbg_err_t code) : std::runtime_error("HDRBG error"), code_(code)
+    {
+    }
+
+    hdrbg_err_t code(void) const noexcept
+    {
+        return code_;
+    }
+
+private:
+    hdrbg_err_t code_;
+};
+
+/******************************************************************************
+ * Owning wrapper around a dynamically allocated HDRBG object, usable as a
+ * uniform random bit generator by the standard library.
+ *
+ * Numbers are taken from a buffer which is refilled with a single request when
+ * it runs out, so that most calls to `operator()` do not leave the inline
+ * code. Hence, the sequence of numbers generated is not the same as that
+ * generated by calling `hdrbg_rand` repeatedly.
+ *****************************************************************************/
+class engine
+{
+public:
+    using result_type = std::uint64_t;
+
+    engine(void) : hd_(hdrbg_init(true)), position_(block_length)
+    {
+        if (hd_ == nullptr)
+        {
+            throw error(hdrbg_err_get());
+        }
+    }
+
+    explicit engine(hdrbg_hash_t hash) : hd_(hdrbg_init_ex(hash)), position_(block_length)
+    {
+        if (hd_ == nullptr)
+        {
+            throw error(hdrbg_err_get());
+        }
+    }
+
+    engine(engine const &) = delete;
+    engine &operator=(engine const &) = delete;
+
+    // The numbers buffered by the other engine are not carried over.
+    engine(engine &&other) noexcept : hd_(std::exchange(other.hd_, nullptr)), position_(block_length)
+    {
+        other.discard_buffer();
+    }
+
+    engine &operator=(engine &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            hd_ = std::exchange(other.hd_, nullptr);
+            other.discard_buffer();
+        }
+        return *this;
+    }
+
+    ~engine()
+    {
+        release();
+    }
+
+    static constexpr result_type min(void)
+    {
+        return std::numeric_limits<result_type>::min();
+    }
+
+    static constexpr result_type max(void)
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()(void)
+    {
+        if (position_ == block_length)
+        {
+            refill();
+        }
+        return block_[position_++];
+    }
+
+    /**************************************************************************
+     * Reinitialise (reseed) the HDRBG object. Buffered numbers are discarded.
+     *************************************************************************/
+    void reseed(void)
+    {
+        discard_buffer();
+        if (hdrbg_reinit(checked()) == nullptr)
+        {
+            throw error(hdrbg_err_get());
+        }
+    }
+
+    /**************************************************************************
+     * Generate any number of bytes directly (i.e. without using the buffer).
+     *************************************************************************/
+    void fill(std::uint8_t *r_bytes, std::size_t r_length)
+    {
+        if (hdrbg_fill_stream(checked(), false, r_bytes, r_length) != 0)
+        {
+            throw error(hdrbg_err_get());
+        }
+    }
+
+#ifdef __cpp_lib_span
+    template<typename T, std::size_t extent>
+    requires(std::is_integral_v<T> || std::is_same_v<T, std::byte>) void fill(std::span<T, extent> r)
+    {
+        fill(reinterpret_cast<std::uint8_t *>(r.data()), r.size_bytes());
+    }
+#endif
+
+    /**************************************************************************
+     * Obtain the underlying HDRBG object, for use with the C API. It remains
+     * owned by this engine.
+     *************************************************************************/
+    hdrbg_t *get(void) const noexcept
+    {
+        return hd_;
+    }
+
+private:
+    static constexpr std::size_t block_length = 256;
+
+    // Obtain the HDRBG object to pass to the C API, refusing to fall back to
+    // the internal HDRBG object if this engine has been moved from.
+    hdrbg_t *checked(void) const
+    {
+        if (hd_ == nullptr)
+        {
+            throw std::logic_error("HDRBG engine has been moved from");
+        }
+        return hd_;
+    }
+
+    void refill(void)
+    {
+        if (hdrbg_fill(checked(), false, reinterpret_cast<std::uint8_t *>(block_), sizeof block_) != 0)
+        {
+            throw error(hdrbg_err_get());
+        }
+        position_ = 0;
+    }
+
+    // Overwrite the numbers which have not been used yet, so that they do not
+    // linger in memory.
+    void discard_buffer(void) noexcept
+    {
+        for (std::size_t i = 0; i < block_length; ++i)
+        {
+            static_cast<result_type volatile &>(block_[i]) = 0;
+        }
+        position_ = block_length;
+    }
+
+    // A moved-from engine does not own an HDRBG object. (Passing a null
+    // pointer to the C API would select the internal HDRBG object instead.)
+    void release(void) noexcept
+    {
+        discard_buffer();
+        if (hd_ != nullptr)
+        {
+            hdrbg_zero(hd_);
+            hd_ = nullptr;
+        }
+    }
+
+    hdrbg_t *hd_;
+    std::size_t position_;
+    result_type block_[block_length];
+};
+}  // namespace hdrbg
+
+#endif  // TFPF_HASH_DRBG_INCLUDE_HDRBG_HPP_
@@ -4,6 +4,15 @@
 #include <inttypes.h>
 #include <stddef.h>
 
-uint8_t *sha256(uint8_t const *message_, size_t length_, uint8_t *h_bytes);
+// Maximum number of messages `sha256_multi` and `sha512_multi` can hash in
+// one call.
+#define SHA256_MULTI_LIMIT 16
+#define SHA512_MULTI_LIMIT 16
+
+char const *sha256_backend(void);
+uint8_t *sha256(uint8_t const *m_bytes, size_t m_length, uint8_t *h_bytes);
+void sha256_multi(uint8_t const *m_bytes, size_t m_length, size_t count, uint8_t *h_bytes);
+uint8_t *sha512(uint8_t const *m_bytes, size_t m_length, uint8_t *h_bytes);
+void sha512_multi(uint8_t const *m_bytes, size_t m_length, size_t count, uint8_t *h_bytes);
 
 #endif  // TFPF_HASH_DRBG_INCLUDE_SHA_H_
@@ -0,0 +1,154 @@
+// Required for `O_CLOEXEC`, which is hidden in strictly conforming mode.
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "entropy.h"
+
+#if defined __unix__ || defined __APPLE__
+#define TFPF_HASH_DRBG_POSIX 1
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined __linux__ && defined __has_include
+#if __has_include(<sys/random.h>)
+#define TFPF_HASH_DRBG_GETRANDOM 1
+#include <sys/random.h>
+#endif
+#endif
+
+#if defined TFPF_HASH_DRBG_POSIX && !defined __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+static atomic_int
+#else
+static int
+#endif
+    entropy_fd
+    = -1;
+
+#ifdef TFPF_HASH_DRBG_GETRANDOM
+/******************************************************************************
+ * Read bytes using the `getrandom` system call.
+ *
+ * @param e_bytes Array to store the bytes in. (It must have sufficient space
+ *     for `e_length` elements.)
+ * @param e_length Number of bytes to store.
+ *
+ * @return Number of bytes stored, or -1 if the system call is not supported.
+ *****************************************************************************/
+static ptrdiff_t
+entropy_getrandom(uint8_t *e_bytes, size_t e_length)
+{
+    size_t length = 0;
+    while (length < e_length)
+    {
+        ssize_t len = getrandom(e_bytes + length, e_length - length, 0);
+        if (len < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == ENOSYS && length == 0)
+            {
+                return -1;
+            }
+            break;
+        }
+        length += len;
+    }
+    return length;
+}
+#endif
+
+#ifdef TFPF_HASH_DRBG_POSIX
+/******************************************************************************
+ * Obtain a file descriptor of the random device. It is opened on first use
+ * and kept open, so that subsequent reads need only one system call.
+ *
+ * @return File descriptor, or -1 if the random device could not be opened.
+ *****************************************************************************/
+static int
+entropy_device(void)
+{
+    int fd = entropy_fd;
+    if (fd >= 0)
+    {
+        return fd;
+    }
+    fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+#ifndef __STDC_NO_ATOMICS__
+    // If another thread opened the random device in the meantime, use its
+    // file descriptor instead.
+    int expected = -1;
+    if (!atomic_compare_exchange_strong(&entropy_fd, &expected, fd))
+    {
+        close(fd);
+        return expected;
+    }
+#else
+    entropy_fd = fd;
+#endif
+    return fd;
+}
+#endif
+
+/******************************************************************************
+ * Read bytes from the entropy source provided by the operating system.
+ *
+ * @param e_bytes Array to store the bytes in. (It must have sufficient space
+ *     for `e_length` elements.)
+ * @param e_length Number of bytes to store.
+ *
+ * @return Number of bytes stored.
+ *****************************************************************************/
+size_t
+entropy_os(uint8_t *e_bytes, size_t e_length)
+{
+#ifdef TFPF_HASH_DRBG_GETRANDOM
+    ptrdiff_t len = entropy_getrandom(e_bytes, e_length);
+    if (len >= 0)
+    {
+        return len;
+    }
+#endif
+#ifdef TFPF_HASH_DRBG_POSIX
+    int fd = entropy_device();
+    if (fd < 0)
+    {
+        return 0;
+    }
+    size_t length = 0;
+    while (length < e_length)
+    {
+        ssize_t len_ = read(fd, e_bytes + length, e_length - length);
+        if (len_ < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (len_ <= 0)
+        {
+            break;
+        }
+        length += len_;
+    }
+    return length;
+#else
+    FILE *fptr = fopen("/dev/urandom", "rb");
+    if (fptr == NULL)
+    {
+        return 0;
+    }
+    size_t length = fread(e_bytes, sizeof *e_bytes, e_length, fptr);
+    fclose(fptr);
+    return length;
+#endif
+}
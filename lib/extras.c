@@ -4,6 +4,10 @@
 
 #include "extras.h"
 
+#if (defined __GNUC__ || defined __clang__) && defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define TFPF_HASH_DRBG_BSWAP 1
+#endif
+
 /******************************************************************************
  * Clear memory. Since this file is compiled separately, this function
  * shouldn't be optimised out when called just before freeing the memory.
@@ -28,6 +32,20 @@ memclear(void *ptr, size_t sz)
 uint64_t
 memcompose(uint8_t const *m_bytes, size_t m_length)
 {
+#ifdef TFPF_HASH_DRBG_BSWAP
+    if (m_length == 8)
+    {
+        uint64_t value;
+        memcpy(&value, m_bytes, 8);
+        return __builtin_bswap64(value);
+    }
+    if (m_length == 4)
+    {
+        uint32_t value;
+        memcpy(&value, m_bytes, 4);
+        return __builtin_bswap32(value);
+    }
+#endif
     uint64_t value = 0;
     while (m_length-- > 0)
     {
@@ -49,6 +67,20 @@ memcompose(uint8_t const *m_bytes, size_t m_length)
 size_t
 memdecompose(uint8_t *m_bytes, size_t m_length, uint64_t value)
 {
+#ifdef TFPF_HASH_DRBG_BSWAP
+    if (m_length == 8)
+    {
+        value = __builtin_bswap64(value);
+        memcpy(m_bytes, &value, 8);
+        return 8;
+    }
+    if (m_length == 4)
+    {
+        uint32_t value32 = __builtin_bswap32(value);
+        memcpy(m_bytes, &value32, 4);
+        return 4;
+    }
+#endif
     for (size_t i = m_length; i > 0; --i)
     {
         m_bytes[i - 1] = value;
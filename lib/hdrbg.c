@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <stdalign.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -8,6 +9,17 @@
 #include <string.h>
 #include <time.h>
 
+#if defined __unix__ || defined __APPLE__
+#include <sys/uio.h>
+#else
+struct iovec
+{
+    void *iov_base;
+    size_t iov_len;
+};
+#endif
+
+#include "entropy.h"
 #include "extras.h"
 #include "hdrbg.h"
 #include "sha.h"
@@ -23,6 +35,9 @@ static int long long unsigned
 
 #if !(defined __STDC_NO_THREADS__ || defined _WIN32)
 #include <threads.h>
+#ifndef __STDC_NO_ATOMICS__
+#define TFPF_HASH_DRBG_PREFETCH 1
+#endif
 static thread_local enum hdrbg_err_t
 #else
 static enum hdrbg_err_t
@@ -30,28 +45,162 @@ static enum hdrbg_err_t
     hdrbg_err
     = HDRBG_ERR_NONE;
 
-#define HDRBG_SEED_LENGTH 55
+#if defined __unix__ || defined __APPLE__
+#include <pthread.h>
+#define TFPF_HASH_DRBG_ATFORK 1
+#endif
+
+// Incremented in the child process whenever the process forks. It is only
+// written while the child process has a single thread, so it need not be
+// atomic.
+static int unsigned fork_generation = 0;
+
+// The seed length is always one byte short of a whole number of limbs, so the
+// most significant limb holds seven bytes.
+#define HDRBG_SEED_LIMBS_MAX 14
+#define HDRBG_SEED_LENGTH_MAX (8 * HDRBG_SEED_LIMBS_MAX - 1)
+#define HDRBG_SEED_MASK 0x00FFFFFFFFFFFFFFU
 #define HDRBG_SECURITY_STRENGTH 32
 #define HDRBG_NONCE1_LENGTH 8
 #define HDRBG_NONCE2_LENGTH 8
-#define HDRBG_OUTPUT_LENGTH 32
+#define HDRBG_OUTPUT_LENGTH_MAX 64
+#define HDRBG_MULTI_LIMIT 16
 #define HDRBG_REQUEST_LIMIT (1UL << 16)
 #define HDRBG_RESEED_INTERVAL (1ULL << 48)
+#define HDRBG_BUFFER_LENGTH 2048
+#define HDRBG_CACHE_LINE_LENGTH 64
 
 // Characteristics of test vectors.
 #define HDRBG_TV_ENTROPY_LENGTH 32
 #define HDRBG_TV_NONCE_LENGTH 16
-#define HDRBG_TV_REQUEST_LENGTH 128
+#define HDRBG_TV_REQUEST_LENGTH_MAX (4 * HDRBG_OUTPUT_LENGTH_MAX)
+
+static_assert(SHA256_MULTI_LIMIT >= HDRBG_MULTI_LIMIT && SHA512_MULTI_LIMIT >= HDRBG_MULTI_LIMIT,
+    "the hash functions must be able to hash `HDRBG_MULTI_LIMIT` messages at a time");
+
+// Parameters which depend on the hash function.
+struct hdrbg_variant_t
+{
+    size_t seed_limbs;
+    size_t seed_length;
+    size_t output_length;
+    uint8_t *(*hash)(uint8_t const *, size_t, uint8_t *);
+    void (*hash_multi)(uint8_t const *, size_t, size_t, uint8_t *);
+};
+
+// Indexed by the hash function.
+static struct hdrbg_variant_t const hdrbg_variants[] = {
+    [HDRBG_HASH_SHA256] = { 7, 55, 32, sha256, sha256_multi },
+    [HDRBG_HASH_SHA512] = { 14, 111, 64, sha512, sha512_multi },
+};
 
 struct hdrbg_t
 {
-    // The first member is prepended with a byte whenever it is processed, so
-    // keep an extra byte.
-    uint8_t V[1 + HDRBG_SEED_LENGTH];
-    uint8_t C[HDRBG_SEED_LENGTH];
+    // The zero value selects SHA-256, which is what the internal HDRBG object
+    // uses.
+    enum hdrbg_hash_t hash;
+
+    // Stored as 64-bit limbs, least significant first, so that they can be
+    // added quickly. They are converted to bytes only when hashed. Only as
+    // many limbs as the hash function requires are used.
+    uint64_t V[HDRBG_SEED_LIMBS_MAX];
+    uint64_t C[HDRBG_SEED_LIMBS_MAX];
     uint64_t gen_count;
+    bool seeded;
+
+    // Value of `fork_generation` when last seeded. If it differs, the process
+    // has forked since, and the state is shared with another process.
+    int unsigned generation;
+#ifdef TFPF_HASH_DRBG_STATS
+    struct hdrbg_counters_t stats;
+#endif
+
+    // Bytes generated in advance for the functions which generate numbers,
+    // if buffering is enabled. They are consumed from the end.
+    bool buffered;
+    size_t buf_length;
+    uint8_t buf[HDRBG_BUFFER_LENGTH];
 };
+
+// The source of entropy for seeding and reseeding. If `NULL`, the operating
+// system is used. The function and its context are read and written together
+// while holding the lock, because the helper thread which obtains entropy
+// inputs in advance may read them while they are being changed.
+static struct
+{
+    size_t (*source)(void *, uint8_t *, size_t);
+    void *ctx;
+} entropy_custom;
+#ifndef __STDC_NO_ATOMICS__
+static atomic_flag entropy_custom_lock = ATOMIC_FLAG_INIT;
+#endif
+
+#ifdef TFPF_HASH_DRBG_STATS
+#ifndef __STDC_NO_ATOMICS__
+typedef atomic_ullong hdrbg_counter_t;
+#define HDRBG_TOTAL_ADD(member, value) atomic_fetch_add_explicit(&hdrbg_totals.member, value, memory_order_relaxed)
+#define HDRBG_TOTAL_GET(member) atomic_load_explicit(&hdrbg_totals.member, memory_order_relaxed)
+#else
+typedef int long long unsigned hdrbg_counter_t;
+#define HDRBG_TOTAL_ADD(member, value) (hdrbg_totals.member += (value))
+#define HDRBG_TOTAL_GET(member) (hdrbg_totals.member)
+#endif
+
+// Totals of the counters of all HDRBG objects in the process. (Those of an
+// HDRBG object are not atomic, because it is used by one thread at a time.)
+static struct
+{
+    hdrbg_counter_t requests;
+    hdrbg_counter_t bytes;
+    hdrbg_counter_t reseeds_interval;
+    hdrbg_counter_t reseeds_prediction_resistance;
+    hdrbg_counter_t reseeds_explicit;
+    hdrbg_counter_t reseeds_fork;
+    hdrbg_counter_t entropy_reads;
+    hdrbg_counter_t entropy_ns;
+} hdrbg_totals;
+
+#define HDRBG_COUNT(hd, member, value)                                                                                \
+    do                                                                                                                \
+    {                                                                                                                 \
+        uint64_t value_ = (value);                                                                                    \
+        (hd)->stats.member += value_;                                                                                 \
+        HDRBG_TOTAL_ADD(member, value_);                                                                              \
+    } while (false)
+#else
+#define HDRBG_COUNT(hd, member, value) ((void)(value))
+#endif
+
+// The internal HDRBG object. If the compiler supports standard threads, each
+// thread has its own, which is initialised when it is first used, and cleared
+// when the thread exits.
+#if !(defined __STDC_NO_THREADS__ || defined _WIN32)
+static thread_local struct hdrbg_t hdrbg;
+static tss_t hdrbg_key;
+static once_flag hdrbg_key_flag = ONCE_FLAG_INIT;
+
+/******************************************************************************
+ * Clear the internal HDRBG object of a thread which is exiting.
+ *
+ * @param hd HDRBG object.
+ *****************************************************************************/
+static void
+hdrbg_key_destroy(void *hd)
+{
+    memclear(hd, sizeof(struct hdrbg_t));
+}
+
+/******************************************************************************
+ * Create the key used to arrange for `hdrbg_key_destroy` to be called.
+ *****************************************************************************/
+static void
+hdrbg_key_create(void)
+{
+    tss_create(&hdrbg_key, hdrbg_key_destroy);
+}
+#else
 static struct hdrbg_t hdrbg;
+#endif
 
 /******************************************************************************
  * Obtain the error status.
@@ -64,38 +213,123 @@ hdrbg_err_get(void)
     return err;
 }
 
+/******************************************************************************
+ * Obtain the name of the SHA-256 implementation in use.
+ *****************************************************************************/
+char const *
+hdrbg_backend(void)
+{
+    return sha256_backend();
+}
+
+/******************************************************************************
+ * Compose eight bytes into a number. Unlike `memcompose`, this can be inlined,
+ * so that loops calling it can be vectorised.
+ *
+ * @param m_bytes Array of bytes.
+ *
+ * @return Bytes interpreted as a big-endian integer.
+ *****************************************************************************/
+static inline uint64_t
+compose64(uint8_t const *m_bytes)
+{
+    return (uint64_t)m_bytes[0] << 56 | (uint64_t)m_bytes[1] << 48 | (uint64_t)m_bytes[2] << 40
+        | (uint64_t)m_bytes[3] << 32 | (uint64_t)m_bytes[4] << 24 | (uint64_t)m_bytes[5] << 16
+        | (uint64_t)m_bytes[6] << 8 | (uint64_t)m_bytes[7];
+}
+
+/******************************************************************************
+ * Decompose a number into eight bytes. Unlike `memdecompose`, this can be
+ * inlined.
+ *
+ * @param m_bytes Array to store the bytes of the number in, in big-endian
+ *     order.
+ * @param value Number to be decomposed.
+ *****************************************************************************/
+static inline void
+decompose64(uint8_t *m_bytes, uint64_t value)
+{
+    for (int i = 7; i >= 0; --i)
+    {
+        m_bytes[i] = value;
+        value >>= 8;
+    }
+}
+
+/******************************************************************************
+ * Convert bytes into limbs.
+ *
+ * @param limbs Array to store the limbs in, least significant first.
+ * @param limbs_length Number of limbs.
+ * @param m_bytes Bytes in big-endian order. Must be an array of length
+ *     `8 * limbs_length - 1`.
+ *****************************************************************************/
+static void
+limbs_from_bytes(uint64_t *limbs, size_t limbs_length, uint8_t const *m_bytes)
+{
+    uint8_t top[8] = { 0 };
+    memcpy(top + 1, m_bytes, 7);
+    limbs[limbs_length - 1] = compose64(top);
+    for (size_t i = 0; i < limbs_length - 1; ++i)
+    {
+        limbs[i] = compose64(m_bytes + 7 + 8 * (limbs_length - 2 - i));
+    }
+}
+
+/******************************************************************************
+ * Convert limbs into bytes.
+ *
+ * @param m_bytes Array to store the bytes in, in big-endian order. Must be an
+ *     array of length `8 * limbs_length - 1`.
+ * @param limbs Limbs, least significant first.
+ * @param limbs_length Number of limbs.
+ *****************************************************************************/
+static void
+limbs_to_bytes(uint8_t *m_bytes, uint64_t const *limbs, size_t limbs_length)
+{
+    uint8_t top[8];
+    decompose64(top, limbs[limbs_length - 1]);
+    memcpy(m_bytes, top + 1, 7);
+    for (size_t i = 0; i < limbs_length - 1; ++i)
+    {
+        decompose64(m_bytes + 7 + 8 * (limbs_length - 2 - i), limbs[i]);
+    }
+}
+
 /******************************************************************************
  * Add two numbers. Overwrite the first number with the result, disregarding
- * any carried bytes.
+ * any carried bits.
  *
- * @param a_bytes Array of bytes of the first number in big-endian order.
- * @param a_length Number of bytes of the first number.
- * @param b_bytes Array of bytes of the second number in big-endian order.
- * @param b_length Number of bytes of the second number. Must be less than or
+ * @param a Limbs of the first number, least significant first.
+ * @param a_length Number of limbs of the first number.
+ * @param b Limbs of the second number, least significant first.
+ * @param b_length Number of limbs of the second number. Must be less than or
  *     equal to `a_length`.
  *****************************************************************************/
 static void
-add_accumulate(uint8_t *a_bytes, size_t a_length, uint8_t const *b_bytes, size_t b_length)
+limbs_add(uint64_t *a, size_t a_length, uint64_t const *b, size_t b_length)
 {
-    int unsigned carry = 0;
-    for (; a_length > 0 && b_length > 0; --a_length, --b_length)
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < b_length; ++i)
     {
-        carry = a_bytes[a_length - 1] + carry + b_bytes[b_length - 1];
-        a_bytes[a_length - 1] = carry;
-        carry >>= 8;
+        uint64_t sum = a[i] + carry;
+        carry = sum < carry;
+        a[i] = sum + b[i];
+        carry += a[i] < sum;
     }
-    for (; a_length > 0; --a_length)
+    for (; carry > 0 && i < a_length; ++i)
     {
-        carry += a_bytes[a_length - 1];
-        a_bytes[a_length - 1] = carry;
-        carry >>= 8;
+        carry = ++a[i] == 0;
     }
+    a[a_length - 1] &= HDRBG_SEED_MASK;
 }
 
 /******************************************************************************
  * Hash derivation function. Transform the input bytes into the required number
  * of output bytes using a hash function.
  *
+ * @param variant Parameters of the hash function.
  * @param m_bytes_ Input bytes.
  * @param m_length_ Number of input bytes.
  * @param h_bytes Array to store the output bytes in. (It must have sufficient
@@ -103,23 +337,24 @@ add_accumulate(uint8_t *a_bytes, size_t a_length, uint8_t const *b_bytes, size_t
  * @param h_length Number of output bytes required.
  *****************************************************************************/
 static void
-hash_df(uint8_t const *m_bytes_, size_t m_length_, uint8_t *h_bytes, size_t h_length)
+hash_df(struct hdrbg_variant_t const *variant, uint8_t const *m_bytes_, size_t m_length_, uint8_t *h_bytes,
+    size_t h_length)
 {
     // Construct the data to be hashed in a sufficiently large array.
     size_t m_length = 5 + m_length_;
-    uint8_t m_bytes[93];
+    uint8_t m_bytes[5 + 1 + HDRBG_SEED_LENGTH_MAX + HDRBG_SECURITY_STRENGTH];
     uint32_t nbits = (uint32_t)h_length << 3;
     memdecompose(m_bytes + 1, 4, nbits);
     memcpy(m_bytes + 5, m_bytes_, m_length_ * sizeof *m_bytes_);
 
     // Hash repeatedly.
-    size_t iterations = (h_length - 1) / HDRBG_OUTPUT_LENGTH + 1;
+    size_t iterations = (h_length - 1) / variant->output_length + 1;
     for (size_t i = 1; i <= iterations; ++i)
     {
         m_bytes[0] = i;
-        uint8_t tmp[HDRBG_OUTPUT_LENGTH];
-        sha256(m_bytes, m_length, tmp);
-        size_t len = h_length >= HDRBG_OUTPUT_LENGTH ? HDRBG_OUTPUT_LENGTH : h_length;
+        uint8_t tmp[HDRBG_OUTPUT_LENGTH_MAX];
+        variant->hash(m_bytes, m_length, tmp);
+        size_t len = h_length >= variant->output_length ? variant->output_length : h_length;
         memcpy(h_bytes, tmp, len * sizeof *h_bytes);
         h_length -= len;
         h_bytes += len;
@@ -127,282 +362,1679 @@ hash_df(uint8_t const *m_bytes_, size_t m_length_, uint8_t *h_bytes, size_t h_le
 }
 
 /******************************************************************************
- * Hash generator. Transform the input bytes into the required number of output
- * bytes using a hash function.
+ * Hash derivation function applied to several inputs of the same length. All
+ * the hash function inputs are independent of one another, so they are hashed
+ * several at a time.
  *
- * @param m_bytes_ Input bytes. Must be an array of length `HDRBG_SEED_LENGTH`.
- * @param h_bytes Array to store the output bytes in. (It must have sufficient
- *     space for `h_length` elements.)
- * @param h_length Number of output bytes required.
+ * @param variant Parameters of the hash function.
+ * @param m_bytes_ Input bytes, one input after the other.
+ * @param m_length_ Number of bytes of each input. Must be at most
+ *     `variant->seed_length - 5`, so that the hash function inputs can be
+ *     hashed several at a time.
+ * @param count Number of inputs.
+ * @param h_bytes Array to store the output bytes in, one output after the
+ *     other. (It must have sufficient space for `count * h_length` elements.)
+ * @param h_length Number of output bytes required for each input.
+ *****************************************************************************/
+static void
+hash_df_many(struct hdrbg_variant_t const *variant, uint8_t const *m_bytes_, size_t m_length_, size_t count,
+    uint8_t *h_bytes, size_t h_length)
+{
+    size_t m_length = 5 + m_length_;
+    size_t iterations = (h_length - 1) / variant->output_length + 1;
+    uint32_t nbits = (uint32_t)h_length << 3;
+    for (size_t first = 0; first < count * iterations; first += HDRBG_MULTI_LIMIT)
+    {
+        // The hash function input at position `k` is that of the iteration
+        // `k % iterations` for the input `k / iterations`.
+        size_t batch = count * iterations - first;
+        batch = batch >= HDRBG_MULTI_LIMIT ? HDRBG_MULTI_LIMIT : batch;
+        uint8_t m_bytes[HDRBG_MULTI_LIMIT * HDRBG_SEED_LENGTH_MAX];
+        for (size_t j = 0; j < batch; ++j)
+        {
+            size_t k = first + j;
+            m_bytes[j * m_length] = k % iterations + 1;
+            memdecompose(m_bytes + j * m_length + 1, 4, nbits);
+            memcpy(m_bytes + j * m_length + 5, m_bytes_ + k / iterations * m_length_, m_length_ * sizeof *m_bytes_);
+        }
+        uint8_t tmp[HDRBG_MULTI_LIMIT * HDRBG_OUTPUT_LENGTH_MAX];
+        variant->hash_multi(m_bytes, m_length, batch, tmp);
+        for (size_t j = 0; j < batch; ++j)
+        {
+            size_t k = first + j;
+            size_t offset = k % iterations * variant->output_length;
+            size_t len = h_length - offset >= variant->output_length ? variant->output_length : h_length - offset;
+            memcpy(h_bytes + k / iterations * h_length + offset, tmp + j * variant->output_length, len);
+        }
+    }
+}
+
+/******************************************************************************
+ * Hash generator. Transform the input number into the required number of
+ * output bytes using a hash function. The successive inputs to the hash
+ * function are independent of one another, so they are hashed several at a
+ * time.
+ *
+ * @param variant Parameters of the hash function.
+ * @param limbs_ Input number. Must be an array of length
+ *     `variant->seed_limbs`.
+ * @param iov Arrays to store the output bytes in, one after the other.
+ * @param h_length Number of output bytes required. Must be positive, and
+ *     equal to the total length of the arrays.
  *****************************************************************************/
 static void
-hash_gen(uint8_t const *m_bytes_, uint8_t *h_bytes, size_t h_length)
+hash_gen(struct hdrbg_variant_t const *variant, uint64_t const *limbs_, struct iovec const *iov, size_t h_length)
 {
-    // Construct the data to be hashed.
-    uint8_t m_bytes[HDRBG_SEED_LENGTH];
-    memcpy(m_bytes, m_bytes_, sizeof m_bytes);
+    uint64_t limbs[HDRBG_SEED_LIMBS_MAX];
+    memcpy(limbs, limbs_, variant->seed_limbs * sizeof *limbs);
+    uint64_t const one = 1;
+
+    // Position in the arrays at which to store the next output byte.
+    int idx = 0;
+    size_t offset = 0;
 
     // Hash repeatedly.
-    size_t iterations = (h_length - 1) / HDRBG_OUTPUT_LENGTH + 1;
-    for (size_t i = 0; i < iterations; ++i)
+    size_t iterations = (h_length - 1) / variant->output_length + 1;
+    while (iterations > 0)
     {
-        uint8_t tmp[HDRBG_OUTPUT_LENGTH];
-        sha256(m_bytes, HDRBG_SEED_LENGTH, tmp);
-        size_t len = h_length >= HDRBG_OUTPUT_LENGTH ? HDRBG_OUTPUT_LENGTH : h_length;
-        memcpy(h_bytes, tmp, len * sizeof *h_bytes);
-        h_length -= len;
-        h_bytes += len;
-        uint8_t one = 1;
-        add_accumulate(m_bytes, HDRBG_SEED_LENGTH, &one, 1);
+        size_t count = iterations >= HDRBG_MULTI_LIMIT ? HDRBG_MULTI_LIMIT : iterations;
+        uint8_t m_bytes[HDRBG_MULTI_LIMIT * HDRBG_SEED_LENGTH_MAX];
+        for (size_t i = 0; i < count; ++i)
+        {
+            limbs_to_bytes(m_bytes + i * variant->seed_length, limbs, variant->seed_limbs);
+            limbs_add(limbs, variant->seed_limbs, &one, 1);
+        }
+        uint8_t tmp[HDRBG_MULTI_LIMIT * HDRBG_OUTPUT_LENGTH_MAX];
+        variant->hash_multi(m_bytes, variant->seed_length, count, tmp);
+        size_t tmp_length = count * variant->output_length;
+        tmp_length = h_length >= tmp_length ? tmp_length : h_length;
+        h_length -= tmp_length;
+        iterations -= count;
+        for (uint8_t const *tmp_bytes = tmp; tmp_length > 0; ++idx, offset = 0)
+        {
+            size_t len = iov[idx].iov_len - offset;
+            len = len >= tmp_length ? tmp_length : len;
+            memcpy((uint8_t *)iov[idx].iov_base + offset, tmp_bytes, len);
+            tmp_bytes += len;
+            tmp_length -= len;
+            offset += len;
+            if (offset < iov[idx].iov_len)
+            {
+                break;
+            }
+        }
     }
 }
 
 /******************************************************************************
- * Set the members of an HDRBG object.
+ * Set the members of an HDRBG object, given the new value of V.
  *
  * @param hd HDRBG object.
- * @param s_bytes Array to derive the values of the members from.
- * @param s_length Number of elements in the array.
+ * @param V Array containing 0x00 followed by the new value of V.
  *****************************************************************************/
 static void
-hdrbg_seed(struct hdrbg_t *hd, uint8_t *s_bytes, size_t s_length)
+hdrbg_seed_finish(struct hdrbg_t *hd, uint8_t const *V)
 {
-    hd->V[0] = 0x00U;
-    hash_df(s_bytes, s_length, hd->V + 1, HDRBG_SEED_LENGTH);
-    hash_df(hd->V, HDRBG_SEED_LENGTH + 1, hd->C, HDRBG_SEED_LENGTH);
+    struct hdrbg_variant_t const *variant = hdrbg_variants + hd->hash;
+    uint8_t C[HDRBG_SEED_LENGTH_MAX];
+    hash_df(variant, V, variant->seed_length + 1, C, variant->seed_length);
+    limbs_from_bytes(hd->V, variant->seed_limbs, V + 1);
+    limbs_from_bytes(hd->C, variant->seed_limbs, C);
     hd->gen_count = 0;
+    hd->seeded = true;
+    hd->generation = fork_generation;
+
+    // Bytes generated using the previous state must not be used afterwards.
+    memclear(hd->buf, hd->buf_length * sizeof *hd->buf);
+    hd->buf_length = 0;
 }
 
 /******************************************************************************
- * Read bytes from a stream and store them in an array.
- *
- * @param fptr_ Stream to read bytes from. If `NULL`, a random device will be
- *     opened to read bytes, and then closed.
- * @param m_bytes Array to store the bytes in. (It must have sufficient space
- *     for `m_length` elements.)
- * @param m_length Number of bytes to store.
+ * Set the members of an HDRBG object.
  *
- * @return Number of bytes stored.
+ * @param hd HDRBG object.
+ * @param s_bytes Array to derive the values of the members from.
+ * @param s_length Number of elements in the array.
  *****************************************************************************/
-static size_t
-streamtobytes(FILE *fptr_, uint8_t *m_bytes, size_t m_length)
+static void
+hdrbg_seed(struct hdrbg_t *hd, uint8_t *s_bytes, size_t s_length)
 {
-    FILE *fptr = fptr_ == NULL ? fopen("/dev/urandom", "rb") : fptr_;
-    if (fptr == NULL)
-    {
-        hdrbg_err = HDRBG_ERR_NO_ENTROPY;
-        return 0;
-    }
-    size_t len = fread(m_bytes, sizeof *m_bytes, m_length, fptr);
-    if (len < m_length)
-    {
-        hdrbg_err = HDRBG_ERR_INSUFFICIENT_ENTROPY;
-    }
-    if (fptr_ == NULL)
-    {
-        fclose(fptr);
-    }
-    return len;
+    struct hdrbg_variant_t const *variant = hdrbg_variants + hd->hash;
+    uint8_t V[1 + HDRBG_SEED_LENGTH_MAX] = { 0x00U };
+    hash_df(variant, s_bytes, s_length, V + 1, variant->seed_length);
+    hdrbg_seed_finish(hd, V);
 }
 
 /******************************************************************************
- * Create and/or initialise (seed) an HDRBG object.
+ * Set the source of the entropy used to initialise and reinitialise HDRBG
+ * objects.
  *****************************************************************************/
-struct hdrbg_t *
-hdrbg_init(bool dma)
+void
+hdrbg_set_entropy_source(size_t (*source)(void *ctx, uint8_t *e_bytes, size_t e_length), void *ctx)
 {
-    struct hdrbg_t *hd = dma ? malloc(sizeof *hd) : &hdrbg;
-    if (hd == NULL)
-    {
-        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
-        return NULL;
-    }
-    uint8_t seedmaterial[HDRBG_SECURITY_STRENGTH + HDRBG_NONCE1_LENGTH + HDRBG_NONCE2_LENGTH];
-    if (streamtobytes(NULL, seedmaterial, HDRBG_SECURITY_STRENGTH) < HDRBG_SECURITY_STRENGTH)
+#ifndef __STDC_NO_ATOMICS__
+    while (atomic_flag_test_and_set_explicit(&entropy_custom_lock, memory_order_acquire))
     {
-        goto cleanup_hd;
     }
-    memdecompose(seedmaterial + HDRBG_SECURITY_STRENGTH, HDRBG_NONCE1_LENGTH, time(NULL));
-    memdecompose(seedmaterial + HDRBG_SECURITY_STRENGTH + HDRBG_NONCE1_LENGTH, HDRBG_NONCE2_LENGTH, seq_num++);
-    hdrbg_seed(hd, seedmaterial, sizeof seedmaterial / sizeof *seedmaterial);
-    return hd;
-
-cleanup_hd:
-    hdrbg_zero(hd);
-    return NULL;
+#endif
+    entropy_custom.source = source;
+    entropy_custom.ctx = ctx;
+#ifndef __STDC_NO_ATOMICS__
+    atomic_flag_clear_explicit(&entropy_custom_lock, memory_order_release);
+#endif
 }
 
 /******************************************************************************
- * Reinitialise (reseed) an HDRBG object.
+ * Obtain bytes from the entropy source.
+ *
+ * @param e_bytes Array to store the bytes in. (It must have sufficient space
+ *     for `e_length` elements.)
+ * @param e_length Number of bytes to store.
+ *
+ * @return Number of bytes stored.
  *****************************************************************************/
-struct hdrbg_t *
-hdrbg_reinit(struct hdrbg_t *hd)
+static size_t
+entropy_read(uint8_t *e_bytes, size_t e_length)
 {
-    hd = hd == NULL ? &hdrbg : hd;
-    uint8_t reseedmaterial[1 + HDRBG_SEED_LENGTH + HDRBG_SECURITY_STRENGTH] = { 0x01U };
-    memcpy(reseedmaterial + 1, hd->V + 1, HDRBG_SEED_LENGTH * sizeof *reseedmaterial);
-    if (streamtobytes(NULL, reseedmaterial + 1 + HDRBG_SEED_LENGTH, HDRBG_SECURITY_STRENGTH) < HDRBG_SECURITY_STRENGTH)
+    // The lock is held only while copying, not while the source is called.
+#ifndef __STDC_NO_ATOMICS__
+    while (atomic_flag_test_and_set_explicit(&entropy_custom_lock, memory_order_acquire))
     {
-        return NULL;
     }
-    hdrbg_seed(hd, reseedmaterial, sizeof reseedmaterial / sizeof *reseedmaterial);
-    return hd;
+#endif
+    size_t (*source)(void *, uint8_t *, size_t) = entropy_custom.source;
+    void *ctx = entropy_custom.ctx;
+#ifndef __STDC_NO_ATOMICS__
+    atomic_flag_clear_explicit(&entropy_custom_lock, memory_order_release);
+#endif
+    return source == NULL ? entropy_os(e_bytes, e_length) : source(ctx, e_bytes, e_length);
 }
 
+#ifdef TFPF_HASH_DRBG_PREFETCH
+// States of a slot in the entropy ring.
+#define HDRBG_PREFETCH_EMPTY 0
+#define HDRBG_PREFETCH_BUSY 1
+#define HDRBG_PREFETCH_FULL 2
+
+// How long the helper thread sleeps when the ring is full (in case the
+// signal that a slot became empty was missed).
+#define HDRBG_PREFETCH_WAIT_NS 10000000L
+
+struct hdrbg_prefetch_slot_t
+{
+    alignas(HDRBG_CACHE_LINE_LENGTH) atomic_int state;
+    uint8_t bytes[HDRBG_SECURITY_STRENGTH];
+};
+
+// Entropy inputs obtained in advance by a helper thread. Each slot is filled
+// only by the helper thread, and emptied by whichever thread first changes
+// its state from full to busy. Threads using the ring are counted as readers,
+// and it is not freed until there are none.
+static struct
+{
+    atomic_bool running;
+    atomic_bool stopping;
+    atomic_size_t readers;
+    size_t depth;
+    struct hdrbg_prefetch_slot_t *slots;
+    atomic_size_t cursor;
+    atomic_ullong refills;
+    atomic_ullong hits;
+    atomic_ullong misses;
+    thrd_t helper;
+    mtx_t mtx;
+    cnd_t cnd;
+} prefetch;
+
 /******************************************************************************
- * Generate cryptographically secure pseudorandom bytes.
+ * Keep the entropy ring filled until asked to stop.
+ *
+ * @param arg Ignored.
+ *
+ * @return Ignored.
  *****************************************************************************/
-int
-hdrbg_fill(struct hdrbg_t *hd, bool prediction_resistance, uint8_t *r_bytes, int long unsigned r_length)
+static int
+hdrbg_prefetch_run(void *arg)
 {
-    if (r_length > HDRBG_REQUEST_LIMIT)
-    {
-        hdrbg_err = HDRBG_ERR_INVALID_REQUEST_FILL;
-        return -1;
-    }
-    hd = hd == NULL ? &hdrbg : hd;
-    if (prediction_resistance || hd->gen_count == HDRBG_RESEED_INTERVAL)
+    (void)arg;
+    while (!atomic_load(&prefetch.stopping))
     {
-        if (hdrbg_reinit(hd) == NULL)
+        bool refilled = false;
+        for (size_t i = 0; i < prefetch.depth; ++i)
         {
-            return -1;
+            struct hdrbg_prefetch_slot_t *slot = prefetch.slots + i;
+            if (atomic_load_explicit(&slot->state, memory_order_acquire) != HDRBG_PREFETCH_EMPTY)
+            {
+                continue;
+            }
+            if (entropy_read(slot->bytes, HDRBG_SECURITY_STRENGTH) < HDRBG_SECURITY_STRENGTH)
+            {
+                break;
+            }
+            atomic_store_explicit(&slot->state, HDRBG_PREFETCH_FULL, memory_order_release);
+            atomic_fetch_add_explicit(&prefetch.refills, 1, memory_order_relaxed);
+            refilled = true;
+        }
+        if (!refilled)
+        {
+            struct timespec ts;
+            timespec_get(&ts, TIME_UTC);
+            ts.tv_nsec += HDRBG_PREFETCH_WAIT_NS;
+            if (ts.tv_nsec >= 1000000000L)
+            {
+                ts.tv_nsec -= 1000000000L;
+                ++ts.tv_sec;
+            }
+            mtx_lock(&prefetch.mtx);
+            if (!atomic_load(&prefetch.stopping))
+            {
+                cnd_timedwait(&prefetch.cnd, &prefetch.mtx, &ts);
+            }
+            mtx_unlock(&prefetch.mtx);
         }
     }
-    if (r_length > 0)
-    {
-        hash_gen(hd->V + 1, r_bytes, r_length);
-    }
-
-    // Mutate the state.
-    hd->V[0] = 0x03U;
-    uint8_t tmp[HDRBG_OUTPUT_LENGTH];
-    sha256(hd->V, HDRBG_SEED_LENGTH + 1, tmp);
-    uint8_t gen_count[8];
-    memdecompose(gen_count, 8, ++hd->gen_count);
-    add_accumulate(hd->V + 1, HDRBG_SEED_LENGTH, tmp, HDRBG_OUTPUT_LENGTH);
-    add_accumulate(hd->V + 1, HDRBG_SEED_LENGTH, hd->C, HDRBG_SEED_LENGTH);
-    add_accumulate(hd->V + 1, HDRBG_SEED_LENGTH, gen_count, 8);
     return 0;
 }
 
 /******************************************************************************
- * Helper for `hdrbg_rand`.
+ * Start using the entropy ring, if it exists. If this succeeds,
+ * `hdrbg_prefetch_leave` must be called when done.
  *
- * @param hd
- * @param r
- *
- * @return On success: 0. On failure: -1.
+ * @return Whether the entropy ring exists.
  *****************************************************************************/
-static int
-hdrbg_rand_(struct hdrbg_t *hd, uint64_t *r)
+static bool
+hdrbg_prefetch_enter(void)
 {
-    uint8_t value[8];
-    if (hdrbg_fill(hd, false, value, 8) < 0)
+    // Register before checking, so that `hdrbg_prefetch_stop` either sees
+    // this reader or is seen to have stopped. (Both operations are
+    // sequentially consistent.)
+    atomic_fetch_add(&prefetch.readers, 1);
+    if (!atomic_load(&prefetch.running))
     {
-        return -1;
+        atomic_fetch_sub(&prefetch.readers, 1);
+        return false;
     }
-    *r = memcompose(value, 8);
-    return 0;
+    return true;
 }
 
 /******************************************************************************
- * Generate a cryptographically secure pseudorandom number.
+ * Stop using the entropy ring.
  *****************************************************************************/
-uint64_t
-hdrbg_rand(struct hdrbg_t *hd)
+static void
+hdrbg_prefetch_leave(void)
 {
-    uint64_t r;
-    if (hdrbg_rand_(hd, &r) == -1)
-    {
-        return -1;
-    }
-    return r;
+    atomic_fetch_sub_explicit(&prefetch.readers, 1, memory_order_release);
 }
 
 /******************************************************************************
- * Helper for `hdrbg_uint`.
+ * Take an entropy input from the entropy ring.
  *
- * @param hd
- * @param modulus
- * @param r
+ * @param e_bytes Array to store the entropy input in. Must be an array of
+ *     length `HDRBG_SECURITY_STRENGTH`.
  *
- * @return On success: 0. On failure: -1.
+ * @return Whether an entropy input was available.
  *****************************************************************************/
-static int
-hdrbg_uint_(struct hdrbg_t *hd, uint64_t modulus, uint64_t *r)
+static bool
+hdrbg_prefetch_take(uint8_t *e_bytes)
 {
-    if (modulus == 0)
+    if (!hdrbg_prefetch_enter())
     {
-        hdrbg_err = HDRBG_ERR_INVALID_REQUEST_UINT;
-        return -1;
+        return false;
     }
-    uint64_t upper = 0xFFFFFFFFFFFFFFFFU - 0xFFFFFFFFFFFFFFFFU % modulus;
-    do
+    size_t start = atomic_load_explicit(&prefetch.cursor, memory_order_relaxed);
+    for (size_t i = 0; i < prefetch.depth; ++i)
     {
-        if (hdrbg_rand_(hd, r) == -1)
+        size_t idx = (start + i) % prefetch.depth;
+        struct hdrbg_prefetch_slot_t *slot = prefetch.slots + idx;
+        int state = HDRBG_PREFETCH_FULL;
+        if (atomic_compare_exchange_strong_explicit(&slot->state, &state, HDRBG_PREFETCH_BUSY, memory_order_acquire,
+                memory_order_relaxed))
         {
-            return -1;
+            memcpy(e_bytes, slot->bytes, sizeof slot->bytes);
+            memclear(slot->bytes, sizeof slot->bytes);
+            atomic_store_explicit(&slot->state, HDRBG_PREFETCH_EMPTY, memory_order_release);
+            atomic_store_explicit(&prefetch.cursor, idx + 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&prefetch.hits, 1, memory_order_relaxed);
+            cnd_signal(&prefetch.cnd);
+            hdrbg_prefetch_leave();
+            return true;
         }
-    } while (*r >= upper);
-    *r %= modulus;
-    return 0;
+    }
+    atomic_fetch_add_explicit(&prefetch.misses, 1, memory_order_relaxed);
+    cnd_signal(&prefetch.cnd);
+    hdrbg_prefetch_leave();
+    return false;
 }
+#endif
+
+#ifdef TFPF_HASH_DRBG_ATFORK
+static pthread_once_t hdrbg_atfork_flag = PTHREAD_ONCE_INIT;
 
 /******************************************************************************
- * Generate a cryptographically secure pseudorandom residue.
+ * Make all HDRBG objects in a child process reseed when they are next used.
+ * Also discard the entropy inputs obtained in advance by the parent process,
+ * because the child process would otherwise take the same ones. (The helper
+ * thread does not exist in the child process.)
  *****************************************************************************/
-uint64_t
-hdrbg_uint(struct hdrbg_t *hd, uint64_t modulus)
+static void
+hdrbg_atfork_child(void)
 {
-    uint64_t r;
-    if (hdrbg_uint_(hd, modulus, &r) == -1)
+    ++fork_generation;
+#ifdef TFPF_HASH_DRBG_PREFETCH
+    if (atomic_load(&prefetch.running))
     {
-        return -1;
+        atomic_store(&prefetch.running, false);
+        memclear(prefetch.slots, prefetch.depth * sizeof *prefetch.slots);
+        free(prefetch.slots);
+        prefetch.slots = NULL;
+        prefetch.depth = 0;
     }
-    return r;
+
+    // Threads which were using the ring when the process forked do not exist
+    // in the child process, so they will never stop using it.
+    atomic_store(&prefetch.readers, 0);
+#endif
 }
 
 /******************************************************************************
- * Generate a cryptographically secure pseudorandom residue offset.
+ * Register `hdrbg_atfork_child`.
  *****************************************************************************/
-int64_t
-hdrbg_span(struct hdrbg_t *hd, int64_t left, int64_t right)
+static void
+hdrbg_atfork_register(void)
+{
+    pthread_atfork(NULL, NULL, hdrbg_atfork_child);
+}
+#endif
+
+/******************************************************************************
+ * Arrange for forks to be detected. This must be done before anything which
+ * a child process could share with its parent process is created.
+ *****************************************************************************/
+static void
+hdrbg_atfork_watch(void)
+{
+#ifdef TFPF_HASH_DRBG_ATFORK
+    pthread_once(&hdrbg_atfork_flag, hdrbg_atfork_register);
+#endif
+}
+
+/******************************************************************************
+ * Start obtaining entropy inputs in advance.
+ *****************************************************************************/
+int
+hdrbg_prefetch_start(size_t depth)
+{
+#ifdef TFPF_HASH_DRBG_PREFETCH
+    hdrbg_atfork_watch();
+    hdrbg_prefetch_stop();
+    if (depth == 0)
+    {
+        return 0;
+    }
+    prefetch.slots = aligned_alloc(alignof(struct hdrbg_prefetch_slot_t), depth * sizeof *prefetch.slots);
+    if (prefetch.slots == NULL)
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        return -1;
+    }
+    for (size_t i = 0; i < depth; ++i)
+    {
+        atomic_init(&prefetch.slots[i].state, HDRBG_PREFETCH_EMPTY);
+    }
+    prefetch.depth = depth;
+    atomic_store(&prefetch.cursor, 0);
+    atomic_store(&prefetch.refills, 0);
+    atomic_store(&prefetch.hits, 0);
+    atomic_store(&prefetch.misses, 0);
+    atomic_store(&prefetch.stopping, false);
+    if (mtx_init(&prefetch.mtx, mtx_plain) != thrd_success)
+    {
+        goto cleanup_slots;
+    }
+    if (cnd_init(&prefetch.cnd) != thrd_success)
+    {
+        goto cleanup_mtx;
+    }
+    if (thrd_create(&prefetch.helper, hdrbg_prefetch_run, NULL) != thrd_success)
+    {
+        goto cleanup_cnd;
+    }
+    atomic_store_explicit(&prefetch.running, true, memory_order_release);
+    return 0;
+
+cleanup_cnd:
+    cnd_destroy(&prefetch.cnd);
+cleanup_mtx:
+    mtx_destroy(&prefetch.mtx);
+cleanup_slots:
+    free(prefetch.slots);
+    prefetch.slots = NULL;
+    prefetch.depth = 0;
+#else
+    (void)depth;
+#endif
+    hdrbg_err = HDRBG_ERR_NO_THREADS;
+    return -1;
+}
+
+/******************************************************************************
+ * Stop obtaining entropy inputs in advance.
+ *****************************************************************************/
+void
+hdrbg_prefetch_stop(void)
+{
+#ifdef TFPF_HASH_DRBG_PREFETCH
+    if (!atomic_load(&prefetch.running))
+    {
+        return;
+    }
+    atomic_store(&prefetch.running, false);
+
+    // Threads which saw the ring before it was marked as stopped may still be
+    // using it.
+    while (atomic_load(&prefetch.readers) > 0)
+    {
+        thrd_yield();
+    }
+    mtx_lock(&prefetch.mtx);
+    atomic_store(&prefetch.stopping, true);
+    cnd_signal(&prefetch.cnd);
+    mtx_unlock(&prefetch.mtx);
+    thrd_join(prefetch.helper, NULL);
+    cnd_destroy(&prefetch.cnd);
+    mtx_destroy(&prefetch.mtx);
+    memclear(prefetch.slots, prefetch.depth * sizeof *prefetch.slots);
+    free(prefetch.slots);
+    prefetch.slots = NULL;
+    prefetch.depth = 0;
+#endif
+}
+
+/******************************************************************************
+ * Obtain statistics about the entropy inputs obtained in advance.
+ *****************************************************************************/
+void
+hdrbg_prefetch_stats(struct hdrbg_prefetch_stats_t *stats)
+{
+    *stats = (struct hdrbg_prefetch_stats_t){ 0 };
+#ifdef TFPF_HASH_DRBG_PREFETCH
+    if (!hdrbg_prefetch_enter())
+    {
+        return;
+    }
+    stats->depth = prefetch.depth;
+    for (size_t i = 0; i < prefetch.depth; ++i)
+    {
+        if (atomic_load_explicit(&prefetch.slots[i].state, memory_order_relaxed) == HDRBG_PREFETCH_FULL)
+        {
+            ++stats->available;
+        }
+    }
+    stats->refills = atomic_load_explicit(&prefetch.refills, memory_order_relaxed);
+    stats->hits = atomic_load_explicit(&prefetch.hits, memory_order_relaxed);
+    stats->misses = atomic_load_explicit(&prefetch.misses, memory_order_relaxed);
+    hdrbg_prefetch_leave();
+#endif
+}
+
+/******************************************************************************
+ * Read bytes from a stream and store them in an array.
+ *
+ * @param fptr Stream to read bytes from. If `NULL`, bytes will be obtained
+ *     from the entropy source.
+ * @param m_bytes Array to store the bytes in. (It must have sufficient space
+ *     for `m_length` elements.)
+ * @param m_length Number of bytes to store.
+ *
+ * @return Number of bytes stored.
+ *****************************************************************************/
+static size_t
+streamtobytes(FILE *fptr, uint8_t *m_bytes, size_t m_length)
+{
+    size_t len;
+    if (fptr != NULL)
+    {
+        len = fread(m_bytes, sizeof *m_bytes, m_length, fptr);
+    }
+    else
+    {
+#ifdef TFPF_HASH_DRBG_PREFETCH
+        if (m_length == HDRBG_SECURITY_STRENGTH && hdrbg_prefetch_take(m_bytes))
+        {
+            return m_length;
+        }
+#endif
+        len = entropy_read(m_bytes, m_length);
+        if (len == 0 && m_length > 0)
+        {
+            hdrbg_err = HDRBG_ERR_NO_ENTROPY;
+            return 0;
+        }
+    }
+    if (len < m_length)
+    {
+        hdrbg_err = HDRBG_ERR_INSUFFICIENT_ENTROPY;
+    }
+    return len;
+}
+
+/******************************************************************************
+ * Obtain entropy for several HDRBG objects in a single read, timing the read if
+ * statistics are enabled. Each HDRBG object counts it as one read, and is
+ * charged an equal share of the time taken.
+ *
+ * @param hds HDRBG objects. None of them may be `NULL`.
+ * @param count Number of HDRBG objects.
+ * @param e_bytes Array to store the bytes in. (It must have sufficient space
+ *     for `count * e_length` elements.)
+ * @param e_length Number of bytes to store for each HDRBG object.
+ *
+ * @return Number of bytes stored.
+ *****************************************************************************/
+static size_t
+hdrbg_entropy_many(struct hdrbg_t *const *hds, size_t count, uint8_t *e_bytes, size_t e_length)
+{
+#ifdef TFPF_HASH_DRBG_STATS
+    struct timespec begin, end;
+    timespec_get(&begin, TIME_UTC);
+    size_t len = streamtobytes(NULL, e_bytes, count * e_length);
+    timespec_get(&end, TIME_UTC);
+    int long long ns = (end.tv_sec - begin.tv_sec) * 1000000000LL + (end.tv_nsec - begin.tv_nsec);
+
+    // The wall clock may have been adjusted while reading.
+    for (size_t i = 0; i < count; ++i)
+    {
+        HDRBG_COUNT(hds[i], entropy_reads, 1);
+        HDRBG_COUNT(hds[i], entropy_ns, ns > 0 ? ns / count : 0);
+    }
+    return len;
+#else
+    (void)hds;
+    return streamtobytes(NULL, e_bytes, count * e_length);
+#endif
+}
+
+/******************************************************************************
+ * Obtain entropy for an HDRBG object, timing the read if statistics are
+ * enabled.
+ *
+ * @param hd HDRBG object. Must not be `NULL`.
+ * @param e_bytes Array to store the bytes in. (It must have sufficient space
+ *     for `e_length` elements.)
+ * @param e_length Number of bytes to store.
+ *
+ * @return Number of bytes stored.
+ *****************************************************************************/
+static size_t
+hdrbg_entropy(struct hdrbg_t *hd, uint8_t *e_bytes, size_t e_length)
+{
+    return hdrbg_entropy_many(&hd, 1, e_bytes, e_length);
+}
+
+/******************************************************************************
+ * Set the members of a newly allocated HDRBG object which are not set when it
+ * is seeded.
+ *
+ * @param hd HDRBG object.
+ * @param hash Hash function.
+ *****************************************************************************/
+static void
+hdrbg_prepare(struct hdrbg_t *hd, enum hdrbg_hash_t hash)
+{
+    hd->hash = hash;
+    hd->buffered = false;
+    hd->buf_length = 0;
+#ifdef TFPF_HASH_DRBG_STATS
+    hd->stats = (struct hdrbg_counters_t){ 0 };
+#endif
+}
+
+/******************************************************************************
+ * Initialise (seed) an HDRBG object using fresh entropy.
+ *
+ * @param hd HDRBG object. Must not be `NULL`.
+ *
+ * @return On success: 0. On failure: -1.
+ *****************************************************************************/
+static int
+hdrbg_instantiate(struct hdrbg_t *hd)
+{
+    hdrbg_atfork_watch();
+    uint8_t seedmaterial[HDRBG_SECURITY_STRENGTH + HDRBG_NONCE1_LENGTH + HDRBG_NONCE2_LENGTH];
+    if (hdrbg_entropy(hd, seedmaterial, HDRBG_SECURITY_STRENGTH) < HDRBG_SECURITY_STRENGTH)
+    {
+        return -1;
+    }
+    memdecompose(seedmaterial + HDRBG_SECURITY_STRENGTH, HDRBG_NONCE1_LENGTH, time(NULL));
+    memdecompose(seedmaterial + HDRBG_SECURITY_STRENGTH + HDRBG_NONCE1_LENGTH, HDRBG_NONCE2_LENGTH, seq_num++);
+    hdrbg_seed(hd, seedmaterial, sizeof seedmaterial / sizeof *seedmaterial);
+    return 0;
+}
+
+/******************************************************************************
+ * Helper for `hdrbg_init` and `hdrbg_init_ex`.
+ *
+ * @param dma
+ * @param hash Hash function. Ignored for the internal HDRBG object, which
+ *     always uses SHA-256.
+ *
+ * @return On success: HDRBG object. On failure: `NULL`.
+ *****************************************************************************/
+static struct hdrbg_t *
+hdrbg_init_(bool dma, enum hdrbg_hash_t hash)
+{
+    struct hdrbg_t *hd = dma ? malloc(sizeof *hd) : &hdrbg;
+    if (hd == NULL)
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        return NULL;
+    }
+    if (dma)
+    {
+        hdrbg_prepare(hd, hash);
+    }
+    if (hdrbg_instantiate(hd) < 0)
+    {
+        goto cleanup_hd;
+    }
+#if !(defined __STDC_NO_THREADS__ || defined _WIN32)
+    if (!dma)
+    {
+        call_once(&hdrbg_key_flag, hdrbg_key_create);
+        tss_set(hdrbg_key, hd);
+    }
+#endif
+    return hd;
+
+cleanup_hd:
+    hdrbg_zero(hd);
+    return NULL;
+}
+
+/******************************************************************************
+ * Create and/or initialise (seed) an HDRBG object.
+ *****************************************************************************/
+struct hdrbg_t *
+hdrbg_init(bool dma)
+{
+    return hdrbg_init_(dma, HDRBG_HASH_SHA256);
+}
+
+/******************************************************************************
+ * Create and initialise (seed) an HDRBG object which uses the given hash
+ * function.
+ *****************************************************************************/
+struct hdrbg_t *
+hdrbg_init_ex(enum hdrbg_hash_t hash)
+{
+    if (hash != HDRBG_HASH_SHA256 && hash != HDRBG_HASH_SHA512)
+    {
+        hdrbg_err = HDRBG_ERR_INVALID_HASH;
+        return NULL;
+    }
+    return hdrbg_init_(true, hash);
+}
+
+/******************************************************************************
+ * Create and initialise (seed) several HDRBG objects.
+ *****************************************************************************/
+int
+hdrbg_init_many(struct hdrbg_t **hds, size_t count)
+{
+    size_t s_length = HDRBG_SECURITY_STRENGTH + HDRBG_NONCE1_LENGTH + HDRBG_NONCE2_LENGTH;
+    if (count == 0)
+    {
+        return 0;
+    }
+    if (count > SIZE_MAX / (HDRBG_SECURITY_STRENGTH + s_length))
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        return -1;
+    }
+    size_t created = 0;
+    uint8_t *e_bytes = malloc(count * (HDRBG_SECURITY_STRENGTH + s_length) * sizeof *e_bytes);
+    if (e_bytes == NULL)
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+    for (; created < count; ++created)
+    {
+        hds[created] = malloc(sizeof *hds[created]);
+        if (hds[created] == NULL)
+        {
+            hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+        hdrbg_prepare(hds[created], HDRBG_HASH_SHA256);
+    }
+    hdrbg_atfork_watch();
+    if (hdrbg_entropy_many(hds, count, e_bytes, HDRBG_SECURITY_STRENGTH) < count * HDRBG_SECURITY_STRENGTH)
+    {
+        goto cleanup;
+    }
+
+    // Reserve the sequence numbers for all HDRBG objects at once. (If the
+    // sequence number is atomic, this is a single atomic operation.)
+    int long long unsigned seq_num_first = (seq_num += count) - count;
+    time_t now = time(NULL);
+    uint8_t *s_bytes = e_bytes + count * HDRBG_SECURITY_STRENGTH;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint8_t *seedmaterial = s_bytes + i * s_length;
+        memcpy(seedmaterial, e_bytes + i * HDRBG_SECURITY_STRENGTH, HDRBG_SECURITY_STRENGTH * sizeof *e_bytes);
+        memdecompose(seedmaterial + HDRBG_SECURITY_STRENGTH, HDRBG_NONCE1_LENGTH, now);
+        memdecompose(seedmaterial + HDRBG_SECURITY_STRENGTH + HDRBG_NONCE1_LENGTH, HDRBG_NONCE2_LENGTH,
+            seq_num_first + i);
+    }
+
+    // The seed material is short enough that V can be derived for several
+    // HDRBG objects at a time. C cannot, because it is derived from more
+    // bytes.
+    struct hdrbg_variant_t const *variant = hdrbg_variants + HDRBG_HASH_SHA256;
+    for (size_t first = 0; first < count; first += HDRBG_MULTI_LIMIT)
+    {
+        size_t batch = count - first >= HDRBG_MULTI_LIMIT ? HDRBG_MULTI_LIMIT : count - first;
+        uint8_t V_bytes[HDRBG_MULTI_LIMIT * HDRBG_SEED_LENGTH_MAX];
+        hash_df_many(variant, s_bytes + first * s_length, s_length, batch, V_bytes, variant->seed_length);
+        for (size_t j = 0; j < batch; ++j)
+        {
+            uint8_t V[1 + HDRBG_SEED_LENGTH_MAX] = { 0x00U };
+            memcpy(V + 1, V_bytes + j * variant->seed_length, variant->seed_length * sizeof *V);
+            hdrbg_seed_finish(hds[first + j], V);
+        }
+    }
+    memclear(e_bytes, count * (HDRBG_SECURITY_STRENGTH + s_length) * sizeof *e_bytes);
+    free(e_bytes);
+    return 0;
+
+cleanup:
+    if (e_bytes != NULL)
+    {
+        memclear(e_bytes, count * (HDRBG_SECURITY_STRENGTH + s_length) * sizeof *e_bytes);
+    }
+    free(e_bytes);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i < created)
+        {
+            hdrbg_zero(hds[i]);
+        }
+        hds[i] = NULL;
+    }
+    return -1;
+}
+
+/******************************************************************************
+ * Obtain the HDRBG object to use.
+ *
+ * @param hd HDRBG object. If `NULL`, the internal HDRBG object will be used.
+ *     (It will be initialised if it has not been.)
+ *
+ * @return On success: HDRBG object. On failure: `NULL`.
+ *****************************************************************************/
+static struct hdrbg_t *
+hdrbg_resolve(struct hdrbg_t *hd)
+{
+    if (hd != NULL)
+    {
+        return hd;
+    }
+    if (!hdrbg.seeded)
+    {
+        return hdrbg_init(false);
+    }
+    return &hdrbg;
+}
+
+/******************************************************************************
+ * Reseed an HDRBG object using fresh entropy.
+ *
+ * @param hd HDRBG object. Must not be `NULL`.
+ *
+ * @return On success: 0. On failure: -1.
+ *****************************************************************************/
+static int
+hdrbg_reseed(struct hdrbg_t *hd)
+{
+    struct hdrbg_variant_t const *variant = hdrbg_variants + hd->hash;
+    uint8_t reseedmaterial[1 + HDRBG_SEED_LENGTH_MAX + HDRBG_SECURITY_STRENGTH] = { 0x01U };
+    limbs_to_bytes(reseedmaterial + 1, hd->V, variant->seed_limbs);
+    uint8_t *e_bytes = reseedmaterial + 1 + variant->seed_length;
+    if (hdrbg_entropy(hd, e_bytes, HDRBG_SECURITY_STRENGTH) < HDRBG_SECURITY_STRENGTH)
+    {
+        return -1;
+    }
+    hdrbg_seed(hd, reseedmaterial, 1 + variant->seed_length + HDRBG_SECURITY_STRENGTH);
+    return 0;
+}
+
+/******************************************************************************
+ * Reinitialise (reseed) an HDRBG object.
+ *****************************************************************************/
+struct hdrbg_t *
+hdrbg_reinit(struct hdrbg_t *hd)
+{
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL || hdrbg_reseed(hd) < 0)
+    {
+        return NULL;
+    }
+    HDRBG_COUNT(hd, reseeds_explicit, 1);
+    return hd;
+}
+
+/******************************************************************************
+ * Reinitialise (reseed) several HDRBG objects.
+ *****************************************************************************/
+int
+hdrbg_reinit_many(struct hdrbg_t **hds, size_t count)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    if (count > SIZE_MAX / HDRBG_SECURITY_STRENGTH)
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        return -1;
+    }
+    uint8_t *e_bytes = malloc(count * HDRBG_SECURITY_STRENGTH * sizeof *e_bytes);
+    if (e_bytes == NULL)
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        return -1;
+    }
+    int status = -1;
+    if (hdrbg_entropy_many(hds, count, e_bytes, HDRBG_SECURITY_STRENGTH) == count * HDRBG_SECURITY_STRENGTH)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            struct hdrbg_variant_t const *variant = hdrbg_variants + hds[i]->hash;
+            uint8_t reseedmaterial[1 + HDRBG_SEED_LENGTH_MAX + HDRBG_SECURITY_STRENGTH] = { 0x01U };
+            limbs_to_bytes(reseedmaterial + 1, hds[i]->V, variant->seed_limbs);
+            memcpy(reseedmaterial + 1 + variant->seed_length, e_bytes + i * HDRBG_SECURITY_STRENGTH,
+                HDRBG_SECURITY_STRENGTH * sizeof *e_bytes);
+            hdrbg_seed(hds[i], reseedmaterial, 1 + variant->seed_length + HDRBG_SECURITY_STRENGTH);
+            HDRBG_COUNT(hds[i], reseeds_explicit, 1);
+        }
+        status = 0;
+    }
+    memclear(e_bytes, count * HDRBG_SECURITY_STRENGTH * sizeof *e_bytes);
+    free(e_bytes);
+    return status;
+}
+
+/******************************************************************************
+ * Reinitialise an HDRBG object if required before generating bytes: if
+ * prediction resistance is requested, if the reseed interval has been reached,
+ * or if the process has forked since it was last seeded.
+ *
+ * @param hd HDRBG object. Must not be `NULL`.
+ * @param prediction_resistance Whether prediction resistance is requested.
+ *
+ * @return On success: 0. On failure: -1.
+ *****************************************************************************/
+static int
+hdrbg_fill_begin(struct hdrbg_t *hd, bool prediction_resistance)
+{
+    bool forked = hd->generation != fork_generation;
+    if (!prediction_resistance && !forked && hd->gen_count != HDRBG_RESEED_INTERVAL)
+    {
+        return 0;
+    }
+    if (hdrbg_reseed(hd) < 0)
+    {
+        return -1;
+    }
+    if (prediction_resistance)
+    {
+        HDRBG_COUNT(hd, reseeds_prediction_resistance, 1);
+    }
+    else if (forked)
+    {
+        HDRBG_COUNT(hd, reseeds_fork, 1);
+    }
+    else
+    {
+        HDRBG_COUNT(hd, reseeds_interval, 1);
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Mutate the state of an HDRBG object after generating bytes.
+ *
+ * @param hd HDRBG object. Must not be `NULL`.
+ * @param r_length Number of bytes generated. (Only used for statistics.)
+ *****************************************************************************/
+static void
+hdrbg_fill_end(struct hdrbg_t *hd, size_t r_length)
+{
+    HDRBG_COUNT(hd, requests, 1);
+    HDRBG_COUNT(hd, bytes, r_length);
+    struct hdrbg_variant_t const *variant = hdrbg_variants + hd->hash;
+    uint8_t V[1 + HDRBG_SEED_LENGTH_MAX] = { 0x03U };
+    limbs_to_bytes(V + 1, hd->V, variant->seed_limbs);
+    uint8_t tmp[HDRBG_OUTPUT_LENGTH_MAX];
+    variant->hash(V, variant->seed_length + 1, tmp);
+    uint64_t H[HDRBG_OUTPUT_LENGTH_MAX / 8];
+    size_t H_length = variant->output_length / 8;
+    for (size_t i = 0; i < H_length; ++i)
+    {
+        H[i] = compose64(tmp + variant->output_length - 8 * (i + 1));
+    }
+    uint64_t gen_count = ++hd->gen_count;
+    limbs_add(hd->V, variant->seed_limbs, H, H_length);
+    limbs_add(hd->V, variant->seed_limbs, hd->C, variant->seed_limbs);
+    limbs_add(hd->V, variant->seed_limbs, &gen_count, 1);
+}
+
+/******************************************************************************
+ * Helper for `hdrbg_fill` and `hdrbg_fill_stream`.
+ *
+ * @param hd HDRBG object. Must not be `NULL`.
+ * @param prediction_resistance
+ * @param r_bytes
+ * @param r_length At most `HDRBG_REQUEST_LIMIT`.
+ *
+ * @return On success: 0. On failure: -1.
+ *****************************************************************************/
+static int
+hdrbg_fill_(struct hdrbg_t *hd, bool prediction_resistance, uint8_t *r_bytes, size_t r_length)
+{
+    if (hdrbg_fill_begin(hd, prediction_resistance) < 0)
+    {
+        return -1;
+    }
+    if (r_length > 0)
+    {
+        struct iovec iov = { .iov_base = r_bytes, .iov_len = r_length };
+        hash_gen(hdrbg_variants + hd->hash, hd->V, &iov, r_length);
+    }
+    hdrbg_fill_end(hd, r_length);
+    return 0;
+}
+
+/******************************************************************************
+ * Generate cryptographically secure pseudorandom bytes.
+ *****************************************************************************/
+int
+hdrbg_fill(struct hdrbg_t *hd, bool prediction_resistance, uint8_t *r_bytes, int long unsigned r_length)
+{
+    if (r_length > HDRBG_REQUEST_LIMIT)
+    {
+        hdrbg_err = HDRBG_ERR_INVALID_REQUEST_FILL;
+        return -1;
+    }
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL)
+    {
+        return -1;
+    }
+    return hdrbg_fill_(hd, prediction_resistance, r_bytes, r_length);
+}
+
+/******************************************************************************
+ * Generate cryptographically secure pseudorandom bytes and store them in
+ * several arrays.
+ *****************************************************************************/
+int
+hdrbg_fillv(struct hdrbg_t *hd, bool prediction_resistance, struct iovec const *iov, int iov_count)
+{
+    size_t r_length = 0;
+    for (int i = 0; i < iov_count; ++i)
+    {
+        if (iov[i].iov_len > HDRBG_REQUEST_LIMIT - r_length)
+        {
+            hdrbg_err = HDRBG_ERR_INVALID_REQUEST_FILL;
+            return -1;
+        }
+        r_length += iov[i].iov_len;
+    }
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL || hdrbg_fill_begin(hd, prediction_resistance) < 0)
+    {
+        return -1;
+    }
+    if (r_length > 0)
+    {
+        hash_gen(hdrbg_variants + hd->hash, hd->V, iov, r_length);
+    }
+    hdrbg_fill_end(hd, r_length);
+    return 0;
+}
+
+/******************************************************************************
+ * Generate any number of cryptographically secure pseudorandom bytes.
+ *****************************************************************************/
+int
+hdrbg_fill_stream(struct hdrbg_t *hd, bool prediction_resistance, uint8_t *r_bytes, size_t r_length)
+{
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL)
+    {
+        return -1;
+    }
+    do
+    {
+        size_t len = r_length >= HDRBG_REQUEST_LIMIT ? HDRBG_REQUEST_LIMIT : r_length;
+        if (hdrbg_fill_(hd, prediction_resistance, r_bytes, len) < 0)
+        {
+            return -1;
+        }
+        r_bytes += len;
+        r_length -= len;
+    } while (r_length > 0);
+    return 0;
+}
+
+#if !(defined __STDC_NO_THREADS__ || defined _WIN32)
+// Work assigned to one thread by `hdrbg_fill_parallel`: the requests from
+// `first` (inclusive) to `last` (exclusive).
+struct hdrbg_fill_job_t
+{
+    struct hdrbg_variant_t const *variant;
+    uint64_t const (*V)[HDRBG_SEED_LIMBS_MAX];
+    uint8_t *r_bytes;
+    size_t r_length;
+    size_t first;
+    size_t last;
+    thrd_t worker;
+    bool created;
+};
+
+/******************************************************************************
+ * Helper for `hdrbg_fill_parallel`. Generate the bytes of some requests.
+ *
+ * @param job_ Work to do.
+ *
+ * @return 0.
+ *****************************************************************************/
+static int
+hdrbg_fill_work(void *job_)
+{
+    struct hdrbg_fill_job_t const *job = job_;
+    for (size_t i = job->first; i < job->last; ++i)
+    {
+        size_t offset = i * HDRBG_REQUEST_LIMIT;
+        size_t len = job->r_length - offset >= HDRBG_REQUEST_LIMIT ? HDRBG_REQUEST_LIMIT : job->r_length - offset;
+        struct iovec iov = { .iov_base = job->r_bytes + offset, .iov_len = len };
+        hash_gen(job->variant, job->V[i], &iov, len);
+    }
+    return 0;
+}
+#endif
+
+/******************************************************************************
+ * Generate any number of cryptographically secure pseudorandom bytes using
+ * multiple threads.
+ *****************************************************************************/
+int
+hdrbg_fill_parallel(struct hdrbg_t *hd, bool prediction_resistance, uint8_t *r_bytes, size_t r_length,
+    int unsigned threads)
+{
+#if !(defined __STDC_NO_THREADS__ || defined _WIN32)
+    size_t requests = r_length / HDRBG_REQUEST_LIMIT + (r_length % HDRBG_REQUEST_LIMIT != 0);
+    if (threads > requests)
+    {
+        threads = requests;
+    }
+    if (threads <= 1)
+    {
+        return hdrbg_fill_stream(hd, prediction_resistance, r_bytes, r_length);
+    }
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL)
+    {
+        return -1;
+    }
+
+    // Only the state update between requests is sequential. Perform all of
+    // them first, recording the value of the state before each request.
+    uint64_t(*V)[HDRBG_SEED_LIMBS_MAX] = malloc(requests * sizeof *V);
+    struct hdrbg_fill_job_t *jobs = malloc(threads * sizeof *jobs);
+    if (V == NULL || jobs == NULL)
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+    for (size_t i = 0; i < requests; ++i)
+    {
+        if (hdrbg_fill_begin(hd, prediction_resistance) < 0)
+        {
+            goto cleanup;
+        }
+        memcpy(V[i], hd->V, sizeof V[i]);
+        hdrbg_fill_end(hd, i + 1 < requests ? HDRBG_REQUEST_LIMIT : r_length - i * HDRBG_REQUEST_LIMIT);
+    }
+    for (int unsigned i = 0; i < threads; ++i)
+    {
+        jobs[i] = (struct hdrbg_fill_job_t){
+            .variant = hdrbg_variants + hd->hash,
+            .V = (uint64_t const(*)[HDRBG_SEED_LIMBS_MAX])V,
+            .r_bytes = r_bytes,
+            .r_length = r_length,
+            .first = requests * i / threads,
+            .last = requests * (i + 1) / threads,
+        };
+    }
+
+    // The calling thread does the first job. If a thread cannot be created,
+    // its job is done by the calling thread as well.
+    for (int unsigned i = 1; i < threads; ++i)
+    {
+        jobs[i].created = thrd_create(&jobs[i].worker, hdrbg_fill_work, jobs + i) == thrd_success;
+    }
+    hdrbg_fill_work(jobs);
+    for (int unsigned i = 1; i < threads; ++i)
+    {
+        if (jobs[i].created)
+        {
+            thrd_join(jobs[i].worker, NULL);
+        }
+        else
+        {
+            hdrbg_fill_work(jobs + i);
+        }
+    }
+    memclear(V, requests * sizeof *V);
+    free(V);
+    free(jobs);
+    return 0;
+
+cleanup:
+    if (V != NULL)
+    {
+        memclear(V, requests * sizeof *V);
+    }
+    free(V);
+    free(jobs);
+    return -1;
+#else
+    (void)threads;
+    return hdrbg_fill_stream(hd, prediction_resistance, r_bytes, r_length);
+#endif
+}
+
+/******************************************************************************
+ * Enable or disable buffering of the bytes used to generate numbers.
+ *****************************************************************************/
+void
+hdrbg_buffer(struct hdrbg_t *hd, bool buffered)
+{
+    hd = hd == NULL ? &hdrbg : hd;
+    memclear(hd->buf, hd->buf_length * sizeof *hd->buf);
+    hd->buf_length = 0;
+    hd->buffered = buffered;
+}
+
+/******************************************************************************
+ * Multiply two numbers.
+ *
+ * @param a First number.
+ * @param b Second number.
+ * @param lower Lower 64 bits of the product.
+ *
+ * @return Upper 64 bits of the product.
+ *****************************************************************************/
+static inline uint64_t
+mulhilo64(uint64_t a, uint64_t b, uint64_t *lower)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *lower = product;
+    return product >> 64;
+#else
+    uint64_t a_lo = a & 0xFFFFFFFFU, a_hi = a >> 32;
+    uint64_t b_lo = b & 0xFFFFFFFFU, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFU) + lo_hi;
+    *lower = middle << 32 | (lo_lo & 0xFFFFFFFFU);
+    return hi_hi + (hi_lo >> 32) + (middle >> 32);
+#endif
+}
+
+/******************************************************************************
+ * Helper for the functions which generate numbers. Take bytes from the buffer
+ * of an HDRBG object, refilling it first if it does not contain enough bytes.
+ * If buffering is disabled, the buffer is refilled with only 8 bytes, so that
+ * requests for 4 bytes use half of a request each.
+ *
+ * @param hd HDRBG object. If `NULL`, the internal HDRBG object will be used.
+ * @param length Number of bytes to take. Either 4 or 8.
+ * @param r Bytes interpreted as a big-endian integer.
+ *
+ * @return On success: 0. On failure: -1.
+ *****************************************************************************/
+static int
+hdrbg_take(struct hdrbg_t *hd, size_t length, uint64_t *r)
+{
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL)
+    {
+        return -1;
+    }
+    // Bytes buffered before a fork must not be used by the child process.
+    if (hd->buf_length < length || hd->generation != fork_generation)
+    {
+        size_t buf_length = hd->buffered ? HDRBG_BUFFER_LENGTH : 8;
+        memclear(hd->buf, hd->buf_length * sizeof *hd->buf);
+        hd->buf_length = 0;
+        if (hdrbg_fill_(hd, false, hd->buf, buf_length) < 0)
+        {
+            return -1;
+        }
+        hd->buf_length = buf_length;
+    }
+
+    // Clear the bytes as soon as they are used.
+    hd->buf_length -= length;
+    *r = memcompose(hd->buf + hd->buf_length, length);
+    memclear(hd->buf + hd->buf_length, length);
+    return 0;
+}
+
+/******************************************************************************
+ * Helper for `hdrbg_rand`.
+ *
+ * @param hd
+ * @param r
+ *
+ * @return On success: 0. On failure: -1.
+ *****************************************************************************/
+static int
+hdrbg_rand_(struct hdrbg_t *hd, uint64_t *r)
+{
+    return hdrbg_take(hd, 8, r);
+}
+
+/******************************************************************************
+ * Generate a cryptographically secure pseudorandom number.
+ *****************************************************************************/
+uint64_t
+hdrbg_rand(struct hdrbg_t *hd)
+{
+    uint64_t r;
+    if (hdrbg_rand_(hd, &r) == -1)
+    {
+        return -1;
+    }
+    return r;
+}
+
+/******************************************************************************
+ * Helper for `hdrbg_uint`.
+ *
+ * @param hd
+ * @param modulus
+ * @param r
+ *
+ * @return On success: 0. On failure: -1.
+ *****************************************************************************/
+static int
+hdrbg_uint_(struct hdrbg_t *hd, uint64_t modulus, uint64_t *r)
+{
+    if (modulus == 0)
+    {
+        hdrbg_err = HDRBG_ERR_INVALID_REQUEST_UINT;
+        return -1;
+    }
+    if (hdrbg_rand_(hd, r) == -1)
+    {
+        return -1;
+    }
+    uint64_t lower;
+    uint64_t upper = mulhilo64(*r, modulus, &lower);
+
+    // Only a number whose scaled value falls in the leftmost partial interval
+    // could introduce a bias. This is rare, so the division required to
+    // determine whether it does is rarely performed.
+    if (lower < modulus)
+    {
+        uint64_t threshold = -modulus % modulus;
+        while (lower < threshold)
+        {
+            if (hdrbg_rand_(hd, r) == -1)
+            {
+                return -1;
+            }
+            upper = mulhilo64(*r, modulus, &lower);
+        }
+    }
+    *r = upper;
+    return 0;
+}
+
+/******************************************************************************
+ * Generate a cryptographically secure pseudorandom residue.
+ *****************************************************************************/
+uint64_t
+hdrbg_uint(struct hdrbg_t *hd, uint64_t modulus)
+{
+    uint64_t r;
+    if (hdrbg_uint_(hd, modulus, &r) == -1)
+    {
+        return -1;
+    }
+    return r;
+}
+
+/******************************************************************************
+ * Generate a cryptographically secure pseudorandom 32-bit residue.
+ *****************************************************************************/
+uint32_t
+hdrbg_uint32(struct hdrbg_t *hd, uint32_t modulus)
+{
+    if (modulus == 0)
+    {
+        hdrbg_err = HDRBG_ERR_INVALID_REQUEST_UINT;
+        return -1;
+    }
+    uint64_t r;
+    if (hdrbg_take(hd, 4, &r) == -1)
+    {
+        return -1;
+    }
+    uint64_t product = r * modulus;
+    uint32_t lower = product;
+    if (lower < modulus)
+    {
+        uint32_t threshold = -modulus % modulus;
+        while (lower < threshold)
+        {
+            if (hdrbg_take(hd, 4, &r) == -1)
+            {
+                return -1;
+            }
+            product = r * modulus;
+            lower = product;
+        }
+    }
+    return product >> 32;
+}
+
+/******************************************************************************
+ * Generate a cryptographically secure pseudorandom residue offset.
+ *****************************************************************************/
+int64_t
+hdrbg_span(struct hdrbg_t *hd, int64_t left, int64_t right)
+{
+    if (left >= right)
+    {
+        hdrbg_err = HDRBG_ERR_INVALID_REQUEST_SPAN;
+        return -1;
+    }
+    uint64_t uleft = left;
+    uint64_t uright = right;
+    uint64_t modulus = uright - uleft;
+    uint64_t r;
+    if (hdrbg_uint_(hd, modulus, &r) == -1)
+    {
+        return -1;
+    }
+    r += uleft;
+
+    // According to the C standard, implicit conversion of an unsigned integer
+    // into a signed integer when the type of the latter cannot represent the
+    // value of the former results in implementation-defined behaviour. Hence,
+    // type-pun the value, exploiting the fact that fixed-width integers use
+    // two's complement representation.
+    return *(int64_t *)&r;
+}
+
+/******************************************************************************
+ * Generate a cryptographically secure pseudorandom fraction.
+ *****************************************************************************/
+double long
+hdrbg_real(struct hdrbg_t *hd)
+{
+    uint64_t r;
+    if (hdrbg_rand_(hd, &r) == -1)
+    {
+        return -1.0L;
+    }
+    return (double long)r / 0xFFFFFFFFFFFFFFFFU;
+}
+
+/******************************************************************************
+ * Generate a cryptographically secure pseudorandom double-precision fraction.
+ *****************************************************************************/
+double
+hdrbg_double(struct hdrbg_t *hd)
+{
+    uint64_t r;
+    if (hdrbg_rand_(hd, &r) == -1)
+    {
+        return -1.0;
+    }
+
+    // Every multiple of 2 ** −53 in the interval is exactly representable.
+    return (r >> 11) * 0x1p-53;
+}
+
+/******************************************************************************
+ * Generate a cryptographically secure pseudorandom double-precision fraction
+ * which is never 0.
+ *****************************************************************************/
+double
+hdrbg_double_open(struct hdrbg_t *hd)
+{
+    uint64_t r;
+    if (hdrbg_rand_(hd, &r) == -1)
+    {
+        return -1.0;
+    }
+
+    // Odd multiples of 2 ** −53 are exactly representable, and lie strictly
+    // between 0 and 1.
+    return ((r >> 12) + 0.5) * 0x1p-52;
+}
+
+/******************************************************************************
+ * Generate a cryptographically secure pseudorandom single-precision fraction.
+ *****************************************************************************/
+float
+hdrbg_float(struct hdrbg_t *hd)
+{
+    uint64_t r;
+    if (hdrbg_take(hd, 4, &r) == -1)
+    {
+        return -1.0F;
+    }
+    return (uint32_t)(r >> 8) * 0x1p-24F;
+}
+
+/******************************************************************************
+ * Helper for the functions which generate arrays. Fill an array with bytes
+ * using as few requests as possible, and then compose each group of eight
+ * bytes into a number in place.
+ *
+ * @param hd HDRBG object. Must not be `NULL`.
+ * @param r Array to store the numbers in.
+ * @param r_length Number of numbers to generate.
+ *
+ * @return On success: 0. On failure: -1.
+ *****************************************************************************/
+static int
+hdrbg_rand_array_(struct hdrbg_t *hd, uint64_t *r, size_t r_length)
+{
+    if (r_length == 0)
+    {
+        return 0;
+    }
+    if (r_length > SIZE_MAX / 8)
+    {
+        hdrbg_err = HDRBG_ERR_INVALID_REQUEST_FILL;
+        return -1;
+    }
+    if (hdrbg_fill_stream(hd, false, (uint8_t *)r, r_length * 8) < 0)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < r_length; ++i)
+    {
+        r[i] = compose64((uint8_t *)(r + i));
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Generate cryptographically secure pseudorandom numbers.
+ *****************************************************************************/
+int
+hdrbg_rand_array(struct hdrbg_t *hd, uint64_t *r, size_t r_length)
+{
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL)
+    {
+        return -1;
+    }
+    return hdrbg_rand_array_(hd, r, r_length);
+}
+
+/******************************************************************************
+ * Helper for `hdrbg_uint_array` and `hdrbg_span_array`.
+ *
+ * @param hd HDRBG object. Must not be `NULL`.
+ * @param modulus
+ * @param r
+ * @param r_length
+ *
+ * @return On success: 0. On failure: -1.
+ *****************************************************************************/
+static int
+hdrbg_uint_array_(struct hdrbg_t *hd, uint64_t modulus, uint64_t *r, size_t r_length)
+{
+    if (modulus == 0)
+    {
+        hdrbg_err = HDRBG_ERR_INVALID_REQUEST_UINT;
+        return -1;
+    }
+    if (hdrbg_rand_array_(hd, r, r_length) < 0)
+    {
+        return -1;
+    }
+
+    // Replace the rejected numbers with numbers generated separately, a few
+    // at a time. Rejection is possible only in the rare event that the scaled
+    // value falls in the leftmost partial interval, so the threshold is
+    // calculated only then (and only once).
+    uint64_t threshold = 0;
+    bool threshold_known = false;
+    uint64_t spare[32];
+    size_t spare_length = 0;
+    for (size_t i = 0; i < r_length; ++i)
+    {
+        uint64_t lower;
+        uint64_t upper = mulhilo64(r[i], modulus, &lower);
+        if (lower < modulus)
+        {
+            if (!threshold_known)
+            {
+                threshold = -modulus % modulus;
+                threshold_known = true;
+            }
+            while (lower < threshold)
+            {
+                if (spare_length == 0)
+                {
+                    if (hdrbg_rand_array_(hd, spare, 32) < 0)
+                    {
+                        return -1;
+                    }
+                    spare_length = 32;
+                }
+                upper = mulhilo64(spare[--spare_length], modulus, &lower);
+            }
+        }
+        r[i] = upper;
+    }
+    memclear(spare, sizeof spare);
+    return 0;
+}
+
+/******************************************************************************
+ * Generate cryptographically secure pseudorandom residues.
+ *****************************************************************************/
+int
+hdrbg_uint_array(struct hdrbg_t *hd, uint64_t modulus, uint64_t *r, size_t r_length)
+{
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL)
+    {
+        return -1;
+    }
+    return hdrbg_uint_array_(hd, modulus, r, r_length);
+}
+
+/******************************************************************************
+ * Generate cryptographically secure pseudorandom residue offsets.
+ *****************************************************************************/
+int
+hdrbg_span_array(struct hdrbg_t *hd, int64_t left, int64_t right, int64_t *r, size_t r_length)
 {
     if (left >= right)
     {
         hdrbg_err = HDRBG_ERR_INVALID_REQUEST_SPAN;
         return -1;
     }
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL)
+    {
+        return -1;
+    }
     uint64_t uleft = left;
     uint64_t uright = right;
-    uint64_t modulus = uright - uleft;
-    uint64_t r;
-    if (hdrbg_uint_(hd, modulus, &r) == -1)
+
+    // The signed and unsigned variants of an integer type may alias each
+    // other, so this avoids implementation-defined behaviour the same way
+    // `hdrbg_span` does.
+    uint64_t *ur = (uint64_t *)r;
+    if (hdrbg_uint_array_(hd, uright - uleft, ur, r_length) < 0)
     {
         return -1;
     }
-    r += uleft;
-
-    // According to the C standard, implicit conversion of an unsigned integer
-    // into a signed integer when the type of the latter cannot represent the
-    // value of the former results in implementation-defined behaviour. Hence,
-    // type-pun the value, exploiting the fact that fixed-width integers use
-    // two's complement representation.
-    return *(int64_t *)&r;
+    for (size_t i = 0; i < r_length; ++i)
+    {
+        ur[i] += uleft;
+    }
+    return 0;
 }
 
 /******************************************************************************
- * Generate a cryptographically secure pseudorandom fraction.
+ * Generate cryptographically secure pseudorandom fractions.
  *****************************************************************************/
-double long
-hdrbg_real(struct hdrbg_t *hd)
+int
+hdrbg_real_array(struct hdrbg_t *hd, double *r, size_t r_length)
 {
-    uint64_t r;
-    if (hdrbg_rand_(hd, &r) == -1)
+    static_assert(sizeof *r == 8, "`double` must be 64 bits wide");
+    hd = hdrbg_resolve(hd);
+    if (hd == NULL)
     {
-        return -1.0L;
+        return -1;
     }
-    return (double long)r / 0xFFFFFFFFFFFFFFFFU;
+    if (r_length == 0)
+    {
+        return 0;
+    }
+    if (r_length > SIZE_MAX / 8)
+    {
+        hdrbg_err = HDRBG_ERR_INVALID_REQUEST_FILL;
+        return -1;
+    }
+    if (hdrbg_fill_stream(hd, false, (uint8_t *)r, r_length * 8) < 0)
+    {
+        return -1;
+    }
+
+    // Multiplying by a power of 2 is exact, and is the same as dividing by
+    // 2 ** 64 − 1 after rounding the latter to the nearest `double`.
+    for (size_t i = 0; i < r_length; ++i)
+    {
+        r[i] = compose64((uint8_t *)(r + i)) * 0x1p-64;
+    }
+    return 0;
 }
 
 /******************************************************************************
@@ -436,6 +2068,253 @@ hdrbg_zero(struct hdrbg_t *hd)
     free(hd);
 }
 
+/******************************************************************************
+ * Obtain the counters of an HDRBG object and the totals of all of them.
+ *****************************************************************************/
+int
+hdrbg_stats_get(struct hdrbg_t *hd, struct hdrbg_stats_t *stats)
+{
+    *stats = (struct hdrbg_stats_t){ 0 };
+#ifdef TFPF_HASH_DRBG_STATS
+    // Do not initialise the internal HDRBG object just to read its counters.
+    stats->object = (hd == NULL ? &hdrbg : hd)->stats;
+    stats->process = (struct hdrbg_counters_t){
+        .requests = HDRBG_TOTAL_GET(requests),
+        .bytes = HDRBG_TOTAL_GET(bytes),
+        .reseeds_interval = HDRBG_TOTAL_GET(reseeds_interval),
+        .reseeds_prediction_resistance = HDRBG_TOTAL_GET(reseeds_prediction_resistance),
+        .reseeds_explicit = HDRBG_TOTAL_GET(reseeds_explicit),
+        .reseeds_fork = HDRBG_TOTAL_GET(reseeds_fork),
+        .entropy_reads = HDRBG_TOTAL_GET(entropy_reads),
+        .entropy_ns = HDRBG_TOTAL_GET(entropy_ns),
+    };
+    return 0;
+#else
+    (void)hd;
+    hdrbg_err = HDRBG_ERR_NO_STATS;
+    return -1;
+#endif
+}
+
+// HDRBG objects in a pool are padded to occupy whole cache lines, so that
+// threads using adjacent objects do not slow one another down.
+#define HDRBG_POOL_SHARDS_LIMIT 16
+#define HDRBG_POOL_INDEX_MASK 0xFFFFFFFFU
+
+#ifndef __STDC_NO_ATOMICS__
+typedef atomic_ullong hdrbg_pool_head_t;
+typedef atomic_uint hdrbg_pool_link_t;
+#else
+typedef int long long unsigned hdrbg_pool_head_t;
+typedef int unsigned hdrbg_pool_link_t;
+#endif
+
+struct hdrbg_pool_entry_t
+{
+    alignas(HDRBG_CACHE_LINE_LENGTH) struct hdrbg_t hd;
+
+    // One more than the index of the next entry in the free list, or 0 if
+    // this is the last entry.
+    hdrbg_pool_link_t next;
+};
+
+struct hdrbg_pool_shard_t
+{
+    // The lower 32 bits are one more than the index of the first entry in the
+    // free list, or 0 if the list is empty. The upper 32 bits count the
+    // modifications of the list, so that a thread which was preempted while
+    // removing an entry cannot succeed if the list changed in the meantime.
+    alignas(HDRBG_CACHE_LINE_LENGTH) hdrbg_pool_head_t head;
+};
+
+struct hdrbg_pool_t
+{
+    // Each shard is a lock-free stack of the entries not in use. A thread
+    // prefers one shard over the others, so that threads seldom contend for
+    // the same stack.
+    struct hdrbg_pool_shard_t shards[HDRBG_POOL_SHARDS_LIMIT];
+    size_t shards_length;
+    size_t entries_length;
+    struct hdrbg_pool_entry_t *entries;
+};
+
+/******************************************************************************
+ * Select the shard of a pool preferred by the calling thread.
+ *
+ * @param pool Pool.
+ *
+ * @return Shard.
+ *****************************************************************************/
+static struct hdrbg_pool_shard_t *
+hdrbg_pool_shard(struct hdrbg_pool_t *pool)
+{
+    // If the compiler supports standard threads, the address of the internal
+    // HDRBG object is different in each thread. Mix its bits, because the
+    // lower bits are the same in all threads.
+    uint64_t key = (uintptr_t)&hdrbg * 0x9E3779B97F4A7C15U;
+    return pool->shards + (key >> 32) % pool->shards_length;
+}
+
+/******************************************************************************
+ * Remove the first entry in the free list of a shard.
+ *
+ * @param pool Pool.
+ * @param shard Shard.
+ *
+ * @return Entry if the list was not empty, else `NULL`.
+ *****************************************************************************/
+static struct hdrbg_pool_entry_t *
+hdrbg_pool_pop(struct hdrbg_pool_t *pool, struct hdrbg_pool_shard_t *shard)
+{
+#ifndef __STDC_NO_ATOMICS__
+    int long long unsigned head = atomic_load_explicit(&shard->head, memory_order_acquire);
+    int long long unsigned next_head;
+    do
+    {
+        int unsigned index = head & HDRBG_POOL_INDEX_MASK;
+        if (index == 0)
+        {
+            return NULL;
+        }
+        int unsigned next = atomic_load_explicit(&pool->entries[index - 1].next, memory_order_relaxed);
+        next_head = ((head >> 32) + 1) << 32 | next;
+    } while (!atomic_compare_exchange_weak_explicit(&shard->head, &head, next_head, memory_order_acquire,
+        memory_order_acquire));
+#else
+    int long long unsigned head = shard->head;
+    if ((head & HDRBG_POOL_INDEX_MASK) == 0)
+    {
+        return NULL;
+    }
+    shard->head = pool->entries[(head & HDRBG_POOL_INDEX_MASK) - 1].next;
+#endif
+    return pool->entries + (head & HDRBG_POOL_INDEX_MASK) - 1;
+}
+
+/******************************************************************************
+ * Insert an entry at the front of the free list of a shard.
+ *
+ * @param pool Pool.
+ * @param shard Shard.
+ * @param entry Entry.
+ *****************************************************************************/
+static void
+hdrbg_pool_push(struct hdrbg_pool_t *pool, struct hdrbg_pool_shard_t *shard, struct hdrbg_pool_entry_t *entry)
+{
+    int unsigned index = entry - pool->entries + 1;
+#ifndef __STDC_NO_ATOMICS__
+    int long long unsigned head = atomic_load_explicit(&shard->head, memory_order_relaxed);
+    int long long unsigned next_head;
+    do
+    {
+        atomic_store_explicit(&entry->next, head & HDRBG_POOL_INDEX_MASK, memory_order_relaxed);
+        next_head = ((head >> 32) + 1) << 32 | index;
+    } while (!atomic_compare_exchange_weak_explicit(&shard->head, &head, next_head, memory_order_release,
+        memory_order_relaxed));
+#else
+    entry->next = shard->head;
+    shard->head = index;
+#endif
+}
+
+/******************************************************************************
+ * Create a pool of initialised HDRBG objects.
+ *****************************************************************************/
+struct hdrbg_pool_t *
+hdrbg_pool_create(size_t count)
+{
+    if (count >= HDRBG_POOL_INDEX_MASK)
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        return NULL;
+    }
+    struct hdrbg_pool_t *pool = aligned_alloc(alignof(struct hdrbg_pool_t), sizeof *pool);
+    if (pool == NULL)
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        return NULL;
+    }
+    pool->shards_length = count == 0 ? 1 : count < HDRBG_POOL_SHARDS_LIMIT ? count : HDRBG_POOL_SHARDS_LIMIT;
+    for (size_t i = 0; i < pool->shards_length; ++i)
+    {
+#ifndef __STDC_NO_ATOMICS__
+        atomic_init(&pool->shards[i].head, 0);
+#else
+        pool->shards[i].head = 0;
+#endif
+    }
+    pool->entries_length = 0;
+    pool->entries = NULL;
+    if (count == 0)
+    {
+        return pool;
+    }
+    pool->entries = aligned_alloc(alignof(struct hdrbg_pool_entry_t), count * sizeof *pool->entries);
+    if (pool->entries == NULL)
+    {
+        hdrbg_err = HDRBG_ERR_OUT_OF_MEMORY;
+        goto cleanup_pool;
+    }
+    for (; pool->entries_length < count; ++pool->entries_length)
+    {
+        struct hdrbg_pool_entry_t *entry = pool->entries + pool->entries_length;
+        hdrbg_prepare(&entry->hd, HDRBG_HASH_SHA256);
+        if (hdrbg_instantiate(&entry->hd) < 0)
+        {
+            goto cleanup_pool;
+        }
+        hdrbg_pool_push(pool, pool->shards + pool->entries_length % pool->shards_length, entry);
+    }
+    return pool;
+
+cleanup_pool:
+    hdrbg_pool_zero(pool);
+    return NULL;
+}
+
+/******************************************************************************
+ * Take an HDRBG object from a pool.
+ *****************************************************************************/
+struct hdrbg_t *
+hdrbg_pool_acquire(struct hdrbg_pool_t *pool)
+{
+    size_t first = hdrbg_pool_shard(pool) - pool->shards;
+    for (size_t i = 0; i < pool->shards_length; ++i)
+    {
+        struct hdrbg_pool_entry_t *entry = hdrbg_pool_pop(pool, pool->shards + (first + i) % pool->shards_length);
+        if (entry != NULL)
+        {
+            return &entry->hd;
+        }
+    }
+    hdrbg_err = HDRBG_ERR_POOL_EMPTY;
+    return NULL;
+}
+
+/******************************************************************************
+ * Return an HDRBG object to the pool it was taken from.
+ *****************************************************************************/
+void
+hdrbg_pool_release(struct hdrbg_pool_t *pool, struct hdrbg_t *hd)
+{
+    // The HDRBG object is the first member of its entry.
+    hdrbg_pool_push(pool, hdrbg_pool_shard(pool), (struct hdrbg_pool_entry_t *)hd);
+}
+
+/******************************************************************************
+ * Zero (clear) and destroy a pool and all HDRBG objects in it.
+ *****************************************************************************/
+void
+hdrbg_pool_zero(struct hdrbg_pool_t *pool)
+{
+    if (pool->entries != NULL)
+    {
+        memclear(pool->entries, pool->entries_length * sizeof *pool->entries);
+        free(pool->entries);
+    }
+    free(pool);
+}
+
 /******************************************************************************
  * Display the given data in hexadecimal form.
  *****************************************************************************/
@@ -460,7 +2339,8 @@ hdrbg_dump(uint8_t const *m_bytes, size_t m_length)
  * and generate without prediction resistance.
  *
  * There are a total of 60 tests without prediction resistance and 60 tests
- * with prediction resistance.
+ * with prediction resistance. Each generates four times as many bytes as the
+ * hash function outputs.
  *
  * @param hd HDRBG object.
  * @param prediction_resistance Prediction resistance.
@@ -469,6 +2349,9 @@ hdrbg_dump(uint8_t const *m_bytes, size_t m_length)
 static void
 hdrbg_tests_pr(struct hdrbg_t *hd, bool prediction_resistance, FILE *tv)
 {
+    struct hdrbg_variant_t const *variant = hdrbg_variants + hd->hash;
+    size_t reseedmaterial_length = 1 + variant->seed_length + HDRBG_TV_ENTROPY_LENGTH;
+    size_t r_length = 4 * variant->output_length;
     for (int i = 0; i < 60; ++i)
     {
         // Initialise.
@@ -477,30 +2360,88 @@ hdrbg_tests_pr(struct hdrbg_t *hd, bool prediction_resistance, FILE *tv)
         hdrbg_seed(hd, seedmaterial, sizeof seedmaterial / sizeof *seedmaterial);
 
         // Reinitialise.
-        uint8_t reseedmaterial[1 + HDRBG_SEED_LENGTH + HDRBG_TV_ENTROPY_LENGTH] = { 0x01U };
-        memcpy(reseedmaterial + 1, hd->V + 1, HDRBG_SEED_LENGTH * sizeof *reseedmaterial);
-        streamtobytes(tv, reseedmaterial + 1 + HDRBG_SEED_LENGTH, HDRBG_TV_ENTROPY_LENGTH);
-        hdrbg_seed(hd, reseedmaterial, sizeof reseedmaterial / sizeof *reseedmaterial);
+        uint8_t reseedmaterial[1 + HDRBG_SEED_LENGTH_MAX + HDRBG_TV_ENTROPY_LENGTH] = { 0x01U };
+        limbs_to_bytes(reseedmaterial + 1, hd->V, variant->seed_limbs);
+        streamtobytes(tv, reseedmaterial + 1 + variant->seed_length, HDRBG_TV_ENTROPY_LENGTH);
+        hdrbg_seed(hd, reseedmaterial, reseedmaterial_length);
 
         // Generate.
-        uint8_t observed[HDRBG_TV_REQUEST_LENGTH];
-        hdrbg_fill(hd, false, observed, HDRBG_TV_REQUEST_LENGTH);
+        uint8_t observed[HDRBG_TV_REQUEST_LENGTH_MAX];
+        hdrbg_fill(hd, false, observed, r_length);
 
         // Reinitialise.
         if (prediction_resistance)
         {
-            memcpy(reseedmaterial + 1, hd->V + 1, HDRBG_SEED_LENGTH * sizeof *reseedmaterial);
-            streamtobytes(tv, reseedmaterial + 1 + HDRBG_SEED_LENGTH, HDRBG_TV_ENTROPY_LENGTH);
-            hdrbg_seed(hd, reseedmaterial, sizeof reseedmaterial / sizeof *reseedmaterial);
+            limbs_to_bytes(reseedmaterial + 1, hd->V, variant->seed_limbs);
+            streamtobytes(tv, reseedmaterial + 1 + variant->seed_length, HDRBG_TV_ENTROPY_LENGTH);
+            hdrbg_seed(hd, reseedmaterial, reseedmaterial_length);
         }
 
         // Generate.
-        hdrbg_fill(hd, false, observed, HDRBG_TV_REQUEST_LENGTH);
+        hdrbg_fill(hd, false, observed, r_length);
+
+        uint8_t expected[HDRBG_TV_REQUEST_LENGTH_MAX];
+        streamtobytes(tv, expected, r_length);
+        assert(memcmp(expected, observed, r_length * sizeof *expected) == 0);
+    }
+}
+
+/******************************************************************************
+ * Verify that generating bytes using multiple threads produces the same bytes
+ * as doing so using one thread.
+ *
+ * @param hd HDRBG object.
+ *****************************************************************************/
+static void
+hdrbg_tests_parallel(struct hdrbg_t *hd)
+{
+    size_t r_length = 5 * HDRBG_REQUEST_LIMIT + HDRBG_TV_REQUEST_LENGTH_MAX;
+    uint8_t *expected = malloc(r_length * sizeof *expected);
+    uint8_t *observed = malloc(r_length * sizeof *observed);
+    bool passed = expected != NULL && observed != NULL;
+    for (int unsigned threads = 1; passed && threads <= 8; threads *= 2)
+    {
+        struct hdrbg_t hd_copy = *hd;
+        passed = hdrbg_fill_stream(&hd_copy, false, expected, r_length) == 0
+            && hdrbg_fill_parallel(hd, false, observed, r_length, threads) == 0
+            && memcmp(expected, observed, r_length * sizeof *expected) == 0
+            && memcmp(hd_copy.V, hd->V, sizeof hd->V) == 0 && hd_copy.gen_count == hd->gen_count;
+        memclear(&hd_copy, sizeof hd_copy);
+    }
+    assert(passed);
+    (void)passed;
+    free(expected);
+    free(observed);
+}
 
-        uint8_t expected[HDRBG_TV_REQUEST_LENGTH];
-        streamtobytes(tv, expected, HDRBG_TV_REQUEST_LENGTH);
-        assert(memcmp(expected, observed, HDRBG_TV_REQUEST_LENGTH * sizeof *expected) == 0);
+/******************************************************************************
+ * Verify that generating bytes into several arrays produces the same bytes as
+ * generating them into one array.
+ *
+ * @param hd HDRBG object.
+ *****************************************************************************/
+static void
+hdrbg_tests_fillv(struct hdrbg_t *hd)
+{
+    size_t output_length = hdrbg_variants[hd->hash].output_length;
+    uint8_t expected[HDRBG_OUTPUT_LENGTH_MAX * (HDRBG_MULTI_LIMIT + 3)];
+    uint8_t observed[HDRBG_OUTPUT_LENGTH_MAX * (HDRBG_MULTI_LIMIT + 3)];
+    size_t lengths[] = { 1, 0, output_length - 1, output_length + 1, output_length * HDRBG_MULTI_LIMIT + 7, 0, 40 };
+    struct iovec iov[sizeof lengths / sizeof *lengths];
+    size_t r_length = 0;
+    for (size_t i = 0; i < sizeof lengths / sizeof *lengths; ++i)
+    {
+        iov[i] = (struct iovec){ .iov_base = observed + r_length, .iov_len = lengths[i] };
+        r_length += lengths[i];
     }
+    struct hdrbg_t hd_copy = *hd;
+    bool passed = hdrbg_fill(&hd_copy, false, expected, r_length) == 0
+        && hdrbg_fillv(hd, false, iov, sizeof iov / sizeof *iov) == 0
+        && memcmp(expected, observed, r_length * sizeof *expected) == 0
+        && memcmp(hd_copy.V, hd->V, sizeof hd->V) == 0;
+    assert(passed);
+    (void)passed;
+    memclear(&hd_copy, sizeof hd_copy);
 }
 
 /******************************************************************************
@@ -520,4 +2461,6 @@ hdrbg_tests(struct hdrbg_t *hd, void *tv)
     hd = hd == NULL ? &hdrbg : hd;
     hdrbg_tests_pr(hd, false, tv);
     hdrbg_tests_pr(hd, true, tv);
+    hdrbg_tests_parallel(hd);
+    hdrbg_tests_fillv(hd);
 }
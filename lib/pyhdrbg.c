@@ -7,6 +7,10 @@
 
 #include "hdrbg.h"
 
+// Releasing and reacquiring the global interpreter lock costs more than
+// generating a few bytes, so do it only for requests at least this long.
+#define GIL_RELEASE_LENGTH 4096
+
 #define ERR_CHECK                                                                                                     \
     do                                                                                                                \
     {                                                                                                                 \
@@ -16,6 +20,62 @@
         }                                                                                                             \
     } while (false)
 
+// The type of HDRBG objects, created when the module is initialised.
+static PyTypeObject *HDRBGType;
+
+// The type `array.array`, which the functions generating many numbers return.
+static PyObject *ArrayType;
+
+typedef struct
+{
+    PyObject_HEAD struct hdrbg_t *hd;
+
+    // Held while the HDRBG object is in use, because the global interpreter
+    // lock may be released during long requests.
+    PyThread_type_lock lock;
+} HDRBGObject;
+
+/******************************************************************************
+ * Obtain the HDRBG object to use, and lock it if required. The functions
+ * below are used both as module functions (which use the internal HDRBG
+ * object) and as methods of `HDRBG` objects.
+ *
+ * @param self Module or `HDRBG` object.
+ *
+ * @return HDRBG object. `NULL` (the internal HDRBG object, which is
+ *     thread-local and hence needs no lock) if `self` is the module.
+ *****************************************************************************/
+static struct hdrbg_t *
+hd_enter(PyObject *self)
+{
+    if (self == NULL || !PyObject_TypeCheck(self, HDRBGType))
+    {
+        return NULL;
+    }
+    HDRBGObject *hdrbg_object = (HDRBGObject *)self;
+    if (!PyThread_acquire_lock(hdrbg_object->lock, NOWAIT_LOCK))
+    {
+        Py_BEGIN_ALLOW_THREADS;
+        PyThread_acquire_lock(hdrbg_object->lock, WAIT_LOCK);
+        Py_END_ALLOW_THREADS;
+    }
+    return hdrbg_object->hd;
+}
+
+/******************************************************************************
+ * Unlock the HDRBG object locked by `hd_enter`, if any.
+ *
+ * @param self Module or `HDRBG` object.
+ *****************************************************************************/
+static void
+hd_leave(PyObject *self)
+{
+    if (self != NULL && PyObject_TypeCheck(self, HDRBGType))
+    {
+        PyThread_release_lock(((HDRBGObject *)self)->lock);
+    }
+}
+
 /******************************************************************************
  * Check whether the error indicator is set. If yes, set a Python exception.
  *
@@ -44,11 +104,20 @@ err_check(void)
     case HDRBG_ERR_INVALID_REQUEST_SPAN:
         PyErr_Format(PyExc_ValueError, "argument 1 must be less than argument 2");
         return -1;
+    case HDRBG_ERR_NO_STATS:
+        PyErr_Format(PyExc_RuntimeError, "statistics were not enabled when compiling");
+        return -1;
     default:
         return 0;
     }
 }
 
+static PyObject *
+Backend(PyObject *self, PyObject *args)
+{
+    return PyUnicode_FromString(hdrbg_backend());
+}
+
 static PyObject *
 Init(PyObject *self, PyObject *args)
 {
@@ -60,7 +129,9 @@ Init(PyObject *self, PyObject *args)
 static PyObject *
 Reinit(PyObject *self, PyObject *args)
 {
-    hdrbg_reinit(NULL);
+    struct hdrbg_t *hd = hd_enter(self);
+    hdrbg_reinit(hd);
+    hd_leave(self);
     ERR_CHECK;
     Py_RETURN_NONE;
 }
@@ -78,19 +149,85 @@ Fill(PyObject *self, PyObject *args)
     {
         return PyErr_Format(PyExc_OverflowError, "argument 1 is out of range of `unsigned long`");
     }
-    static uint8_t r_bytes[65536UL];
-    hdrbg_fill(NULL, false, r_bytes, r_length);
+    if (r_length > 65536UL)
+    {
+        return PyErr_Format(PyExc_ValueError, "argument 1 must be less than or equal to 65536");
+    }
+
+    // Generate the bytes directly in the bytes object. This is okay: CPython
+    // works only on systems on which `char` is 8 bits wide.
+    PyObject *r_bytes = PyBytes_FromStringAndSize(NULL, r_length);
+    if (r_bytes == NULL)
+    {
+        return NULL;
+    }
+    uint8_t *r_bytes_ = (uint8_t *)PyBytes_AS_STRING(r_bytes);
+    struct hdrbg_t *hd = hd_enter(self);
+    if (r_length >= GIL_RELEASE_LENGTH)
+    {
+        Py_BEGIN_ALLOW_THREADS;
+        hdrbg_fill(hd, false, r_bytes_, r_length);
+        Py_END_ALLOW_THREADS;
+    }
+    else
+    {
+        hdrbg_fill(hd, false, r_bytes_, r_length);
+    }
+    hd_leave(self);
+    if (err_check() < 0)
+    {
+        Py_DECREF(r_bytes);
+        return NULL;
+    }
+    return r_bytes;
+}
+
+static PyObject *
+FillInto(PyObject *self, PyObject *args)
+{
+    Py_buffer view;
+    if (!PyArg_ParseTuple(args, "w*", &view))
+    {
+        return NULL;
+    }
+    struct hdrbg_t *hd = hd_enter(self);
+    if (view.len >= GIL_RELEASE_LENGTH)
+    {
+        Py_BEGIN_ALLOW_THREADS;
+        hdrbg_fill_stream(hd, false, view.buf, view.len);
+        Py_END_ALLOW_THREADS;
+    }
+    else
+    {
+        hdrbg_fill_stream(hd, false, view.buf, view.len);
+    }
+    hd_leave(self);
+    Py_ssize_t r_length = view.len;
+    PyBuffer_Release(&view);
     ERR_CHECK;
+    return PyLong_FromSsize_t(r_length);
+}
 
-    // This is okay: CPython works only on systems on which `char` is 8 bits
-    // wide.
-    return PyBytes_FromStringAndSize((char *)r_bytes, r_length);
+static PyObject *
+Buffer(PyObject *self, PyObject *args)
+{
+    int buffered;
+    if (!PyArg_ParseTuple(args, "p", &buffered))
+    {
+        return NULL;
+    }
+    struct hdrbg_t *hd = hd_enter(self);
+    hdrbg_buffer(hd, buffered);
+    hd_leave(self);
+    Py_RETURN_NONE;
 }
 
 static PyObject *
 Rand(PyObject *self, PyObject *args)
 {
-    uint64_t r = hdrbg_rand(NULL);
+    struct hdrbg_t *hd = hd_enter(self);
+    uint64_t r = hdrbg_rand(hd);
+    hd_leave(self);
     ERR_CHECK;
     return PyLong_FromUnsignedLongLong(r);
 }
@@ -108,7 +245,9 @@ Uint(PyObject *self, PyObject *args)
     {
         return PyErr_Format(PyExc_OverflowError, "argument 1 is out of range of `uint64_t`");
     }
-    uint64_t r = hdrbg_uint(NULL, modulus);
+    struct hdrbg_t *hd = hd_enter(self);
+    uint64_t r = hdrbg_uint(hd, modulus);
+    hd_leave(self);
     ERR_CHECK;
     return PyLong_FromUnsignedLongLong(r);
 }
@@ -134,7 +273,9 @@ Span(PyObject *self, PyObject *args)
     {
         return PyErr_Format(PyExc_OverflowError, "argument 1 or argument 2 is out of range of `int64_t`");
     }
-    int64_t r = hdrbg_span(NULL, left, right);
+    struct hdrbg_t *hd = hd_enter(self);
+    int64_t r = hdrbg_span(hd, left, right);
+    hd_leave(self);
     ERR_CHECK;
     return PyLong_FromLongLong(r);
 }
@@ -142,11 +283,213 @@ Span(PyObject *self, PyObject *args)
 static PyObject *
 Real(PyObject *self, PyObject *args)
 {
-    double long r = hdrbg_real(NULL);
+    struct hdrbg_t *hd = hd_enter(self);
+    double r = hdrbg_double(hd);
+    hd_leave(self);
     ERR_CHECK;
     return PyFloat_FromDouble(r);
 }
 
+/******************************************************************************
+ * Create an `array.array` of the given length and obtain its buffer.
+ *
+ * @param typecode Type code of the array. Its items must be 8 bytes wide.
+ * @param count Number of items.
+ * @param view Buffer of the array.
+ *
+ * @return Array, or `NULL` on failure.
+ *****************************************************************************/
+static PyObject *
+array_new(char const *typecode, Py_ssize_t count, Py_buffer *view)
+{
+    if (count < 0)
+    {
+        return PyErr_Format(PyExc_ValueError, "count must be non-negative");
+    }
+
+    // Repeating a one-item array allocates the memory for all items at once.
+    PyObject *array_one = PyObject_CallFunction(ArrayType, "s(i)", typecode, 0);
+    if (array_one == NULL)
+    {
+        return NULL;
+    }
+    PyObject *array = PySequence_Repeat(array_one, count);
+    Py_DECREF(array_one);
+    if (array == NULL)
+    {
+        return NULL;
+    }
+    if (PyObject_GetBuffer(array, view, PyBUF_WRITABLE) < 0)
+    {
+        Py_DECREF(array);
+        return NULL;
+    }
+    if (view->itemsize != 8)
+    {
+        PyBuffer_Release(view);
+        Py_DECREF(array);
+        return PyErr_Format(PyExc_RuntimeError, "array items are not 8 bytes wide");
+    }
+    return array;
+}
+
+/******************************************************************************
+ * Release the buffer obtained by `array_new`, and check whether the array
+ * could be filled.
+ *
+ * @param array Array.
+ * @param view Buffer of the array.
+ *
+ * @return Array, or `NULL` if the error indicator was set.
+ *****************************************************************************/
+static PyObject *
+array_done(PyObject *array, Py_buffer *view)
+{
+    PyBuffer_Release(view);
+    if (err_check() < 0)
+    {
+        Py_DECREF(array);
+        return NULL;
+    }
+    return array;
+}
+
+static PyObject *
+RandMany(PyObject *self, PyObject *args)
+{
+    Py_ssize_t count;
+    if (!PyArg_ParseTuple(args, "n", &count))
+    {
+        return NULL;
+    }
+    Py_buffer view;
+    PyObject *array = array_new("Q", count, &view);
+    if (array == NULL)
+    {
+        return NULL;
+    }
+    struct hdrbg_t *hd = hd_enter(self);
+    if (view.len >= GIL_RELEASE_LENGTH)
+    {
+        Py_BEGIN_ALLOW_THREADS;
+        hdrbg_rand_array(hd, view.buf, count);
+        Py_END_ALLOW_THREADS;
+    }
+    else
+    {
+        hdrbg_rand_array(hd, view.buf, count);
+    }
+    hd_leave(self);
+    return array_done(array, &view);
+}
+
+static PyObject *
+UintMany(PyObject *self, PyObject *args)
+{
+    int long long unsigned modulus;
+    Py_ssize_t count;
+    if (!PyArg_ParseTuple(args, "Kn", &modulus, &count))
+    {
+        return NULL;
+    }
+    modulus = PyLong_AsUnsignedLongLong(PyTuple_GET_ITEM(args, 0));
+    if (PyErr_Occurred() != NULL || modulus > UINT64_MAX)
+    {
+        return PyErr_Format(PyExc_OverflowError, "argument 1 is out of range of `uint64_t`");
+    }
+    Py_buffer view;
+    PyObject *array = array_new("Q", count, &view);
+    if (array == NULL)
+    {
+        return NULL;
+    }
+    struct hdrbg_t *hd = hd_enter(self);
+    if (view.len >= GIL_RELEASE_LENGTH)
+    {
+        Py_BEGIN_ALLOW_THREADS;
+        hdrbg_uint_array(hd, modulus, view.buf, count);
+        Py_END_ALLOW_THREADS;
+    }
+    else
+    {
+        hdrbg_uint_array(hd, modulus, view.buf, count);
+    }
+    hd_leave(self);
+    return array_done(array, &view);
+}
+
+static PyObject *
+SpanMany(PyObject *self, PyObject *args)
+{
+    int long long left, right;
+    Py_ssize_t count;
+    PyObject *err = NULL;
+    if (!PyArg_ParseTuple(args, "LLn", &left, &right, &count))
+    {
+        err = PyErr_Occurred();
+        if (!PyErr_GivenExceptionMatches(err, PyExc_OverflowError))
+        {
+            return NULL;
+        }
+    }
+    if (err != NULL)
+    {
+        return PyErr_Format(PyExc_OverflowError, "argument 1, 2 or 3 is out of range");
+    }
+    else if (left < INT64_MIN || left > INT64_MAX || right < INT64_MIN || right > INT64_MAX)
+    {
+        return PyErr_Format(PyExc_OverflowError, "argument 1 or argument 2 is out of range of `int64_t`");
+    }
+    Py_buffer view;
+    PyObject *array = array_new("q", count, &view);
+    if (array == NULL)
+    {
+        return NULL;
+    }
+    struct hdrbg_t *hd = hd_enter(self);
+    if (view.len >= GIL_RELEASE_LENGTH)
+    {
+        Py_BEGIN_ALLOW_THREADS;
+        hdrbg_span_array(hd, left, right, view.buf, count);
+        Py_END_ALLOW_THREADS;
+    }
+    else
+    {
+        hdrbg_span_array(hd, left, right, view.buf, count);
+    }
+    hd_leave(self);
+    return array_done(array, &view);
+}
+
+static PyObject *
+RealMany(PyObject *self, PyObject *args)
+{
+    Py_ssize_t count;
+    if (!PyArg_ParseTuple(args, "n", &count))
+    {
+        return NULL;
+    }
+    Py_buffer view;
+    PyObject *array = array_new("d", count, &view);
+    if (array == NULL)
+    {
+        return NULL;
+    }
+    struct hdrbg_t *hd = hd_enter(self);
+    if (view.len >= GIL_RELEASE_LENGTH)
+    {
+        Py_BEGIN_ALLOW_THREADS;
+        hdrbg_real_array(hd, view.buf, count);
+        Py_END_ALLOW_THREADS;
+    }
+    else
+    {
+        hdrbg_real_array(hd, view.buf, count);
+    }
+    hd_leave(self);
+    return array_done(array, &view);
+}
+
 static PyObject *
 Drop(PyObject *self, PyObject *args)
 {
@@ -164,18 +507,213 @@ Drop(PyObject *self, PyObject *args)
     {
         return PyErr_Format(PyExc_OverflowError, "argument 1 is out of range of `long long`");
     }
-    hdrbg_drop(NULL, count);
+    struct hdrbg_t *hd = hd_enter(self);
+    hdrbg_drop(hd, count);
+    hd_leave(self);
     ERR_CHECK;
     Py_RETURN_NONE;
 }
 
+/******************************************************************************
+ * Convert counters to a Python dictionary.
+ *
+ * @param counters Counters.
+ *
+ * @return Dictionary mapping the names of the members to their values.
+ *****************************************************************************/
+static PyObject *
+counters_dict(struct hdrbg_counters_t const *counters)
+{
+    char const *names[] = { "requests", "bytes", "reseeds_interval", "reseeds_prediction_resistance",
+        "reseeds_explicit", "reseeds_fork", "entropy_reads", "entropy_ns" };
+    uint64_t values[] = { counters->requests, counters->bytes, counters->reseeds_interval,
+        counters->reseeds_prediction_resistance, counters->reseeds_explicit, counters->reseeds_fork,
+        counters->entropy_reads, counters->entropy_ns };
+    PyObject *dict = PyDict_New();
+    for (size_t i = 0; dict != NULL && i < sizeof names / sizeof *names; ++i)
+    {
+        PyObject *value = PyLong_FromUnsignedLongLong(values[i]);
+        if (value == NULL || PyDict_SetItemString(dict, names[i], value) < 0)
+        {
+            Py_XDECREF(value);
+            Py_DECREF(dict);
+            return NULL;
+        }
+        Py_DECREF(value);
+    }
+    return dict;
+}
+
+static PyObject *
+Stats(PyObject *self, PyObject *args)
+{
+    struct hdrbg_stats_t stats;
+    struct hdrbg_t *hd = hd_enter(self);
+    hdrbg_stats_get(hd, &stats);
+    hd_leave(self);
+    ERR_CHECK;
+    PyObject *object = counters_dict(&stats.object);
+    PyObject *process = counters_dict(&stats.process);
+    PyObject *result = NULL;
+    if (object != NULL && process != NULL)
+    {
+        result = Py_BuildValue("{sOsO}", "object", object, "process", process);
+    }
+    Py_XDECREF(object);
+    Py_XDECREF(process);
+    return result;
+}
+
+static PyObject *
+RandomSeed(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    // The HDRBG object cannot be seeded with a chosen value; it is seeded
+    // using entropy obtained from the operating system.
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RandomState(PyObject *self, PyObject *args)
+{
+    return PyErr_Format(PyExc_NotImplementedError, "the state of an HDRBG object cannot be saved or restored");
+}
+
+static PyObject *
+RandomGetrandbits(PyObject *self, PyObject *args)
+{
+    Py_ssize_t k;
+    if (!PyArg_ParseTuple(args, "n", &k))
+    {
+        return NULL;
+    }
+    if (k < 0)
+    {
+        return PyErr_Format(PyExc_ValueError, "number of bits must be non-negative");
+    }
+    if (k == 0)
+    {
+        return PyLong_FromLong(0);
+    }
+    if (k <= 64)
+    {
+        uint64_t r = hdrbg_rand(NULL);
+        ERR_CHECK;
+        return PyLong_FromUnsignedLongLong(r >> (64 - k));
+    }
+
+    // Generate all bytes with one request (unless there are too many), and
+    // clear the excess bits of the most significant byte.
+    Py_ssize_t r_length = (k - 1) / 8 + 1;
+    PyObject *r_bytes = PyBytes_FromStringAndSize(NULL, r_length);
+    if (r_bytes == NULL)
+    {
+        return NULL;
+    }
+    uint8_t *r_bytes_ = (uint8_t *)PyBytes_AS_STRING(r_bytes);
+    hdrbg_fill_stream(NULL, false, r_bytes_, r_length);
+    if (err_check() < 0)
+    {
+        Py_DECREF(r_bytes);
+        return NULL;
+    }
+    r_bytes_[0] &= 0xFFU >> (8 * r_length - k);
+    PyObject *r = PyObject_CallMethod((PyObject *)&PyLong_Type, "from_bytes", "Os", r_bytes, "big");
+    Py_DECREF(r_bytes);
+    return r;
+}
+
+static PyObject *
+RandomRandbytes(PyObject *self, PyObject *args)
+{
+    Py_ssize_t r_length;
+    if (!PyArg_ParseTuple(args, "n", &r_length))
+    {
+        return NULL;
+    }
+    if (r_length < 0)
+    {
+        return PyErr_Format(PyExc_ValueError, "number of bytes must be non-negative");
+    }
+    PyObject *r_bytes = PyBytes_FromStringAndSize(NULL, r_length);
+    if (r_bytes == NULL)
+    {
+        return NULL;
+    }
+    uint8_t *r_bytes_ = (uint8_t *)PyBytes_AS_STRING(r_bytes);
+    if (r_length >= GIL_RELEASE_LENGTH)
+    {
+        Py_BEGIN_ALLOW_THREADS;
+        hdrbg_fill_stream(NULL, false, r_bytes_, r_length);
+        Py_END_ALLOW_THREADS;
+    }
+    else
+    {
+        hdrbg_fill_stream(NULL, false, r_bytes_, r_length);
+    }
+    if (err_check() < 0)
+    {
+        Py_DECREF(r_bytes);
+        return NULL;
+    }
+    return r_bytes;
+}
+
 static void
 Zero(void)
 {
     hdrbg_zero(NULL);
 }
 
+static PyObject *
+HDRBGNew(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    if (!PyArg_ParseTuple(args, ":HDRBG") || (kwargs != NULL && PyDict_Size(kwargs) > 0))
+    {
+        return PyErr_Format(PyExc_TypeError, "HDRBG() takes no arguments");
+    }
+    HDRBGObject *self = (HDRBGObject *)PyType_GenericAlloc(type, 0);
+    if (self == NULL)
+    {
+        return NULL;
+    }
+    self->lock = PyThread_allocate_lock();
+    if (self->lock == NULL)
+    {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    self->hd = hdrbg_init(true);
+    if (err_check() < 0)
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return (PyObject *)self;
+}
+
+static void
+HDRBGDealloc(PyObject *self)
+{
+    HDRBGObject *hdrbg_object = (HDRBGObject *)self;
+    if (hdrbg_object->hd != NULL)
+    {
+        hdrbg_zero(hdrbg_object->hd);
+    }
+    if (hdrbg_object->lock != NULL)
+    {
+        PyThread_free_lock(hdrbg_object->lock);
+    }
+    PyTypeObject *type = Py_TYPE(self);
+    freefunc tp_free = PyType_GetSlot(type, Py_tp_free);
+    tp_free(self);
+    Py_DECREF(type);
+}
+
 // Module information.
+PyDoc_STRVAR(backend_doc,
+    "backend() -> str\n"
+    "Obtain the name of the SHA-256 implementation in use.\n\n"
+    ":return: One of ``'sha-ni'``, ``'openssl'``, ``'ssse3'`` and ``'generic'``.");
 PyDoc_STRVAR(init_doc,
     "_init()\n"
     "Initialise (seed) the HDRBG object.");
@@ -187,6 +725,18 @@ PyDoc_STRVAR(bytes_doc,
     "Generate cryptographically secure pseudorandom bytes.\n\n"
     ":param r_length: Number of bytes to generate. At most 65536.\n\n"
     ":return: Uniform pseudorandom bytes object.");
+PyDoc_STRVAR(fill_into_doc,
+    "fill_into(buffer) -> int\n"
+    "Generate cryptographically secure pseudorandom bytes directly in the memory of a writable object (such as a "
+    "``bytearray``, ``memoryview``, ``mmap`` or ``array``), filling it completely. Long requests are fulfilled "
+    "without holding the global interpreter lock.\n\n"
+    ":param buffer: Object supporting the writable buffer protocol. Its length is not limited.\n\n"
+    ":return: Number of bytes generated.");
+PyDoc_STRVAR(buffer_doc,
+    "buffer(buffered)\n"
+    "Enable or disable buffering in the HDRBG object. If enabled, ``rand``, ``uint``, ``span`` and ``real`` use bytes "
+    "generated in advance by a single large request, which is much faster.\n\n"
+    ":param buffered: Whether to buffer.");
 PyDoc_STRVAR(rand_doc,
     "rand() -> int\n"
     "Generate a cryptographically secure pseudorandom number.\n\n"
@@ -205,25 +755,155 @@ PyDoc_STRVAR(span_doc,
 PyDoc_STRVAR(real_doc,
     "real() -> float\n"
     "Generate a cryptographically secure pseudorandom fraction.\n\n"
-    ":return: Uniform pseudorandom real in the range 0 (inclusive) to 1 (inclusive).");
+    ":return: Uniform pseudorandom real in the range 0 (inclusive) to 1 (exclusive), a multiple of 2 ** −53.");
+PyDoc_STRVAR(rand_many_doc,
+    "rand_many(count) -> array.array\n"
+    "Generate cryptographically secure pseudorandom numbers in a single pass, without creating a Python integer for "
+    "each.\n\n"
+    ":param count: Number of integers to generate.\n\n"
+    ":return: Array (of type code ``'Q'``) of uniform pseudorandom integers in the range 0 (inclusive) to 2 ** 64 − 1 "
+    "(inclusive).");
+PyDoc_STRVAR(uint_many_doc,
+    "uint_many(modulus, count) -> array.array\n"
+    "Generate cryptographically secure pseudorandom residues in a single pass, without creating a Python integer for "
+    "each.\n\n"
+    ":param modulus: Right end of the interval. Must be positive.\n"
+    ":param count: Number of integers to generate.\n\n"
+    ":return: Array (of type code ``'Q'``) of uniform pseudorandom integers in the range 0 (inclusive) to ``modulus`` "
+    "(exclusive).");
+PyDoc_STRVAR(span_many_doc,
+    "span_many(left, right, count) -> array.array\n"
+    "Generate cryptographically secure pseudorandom residue offsets in a single pass, without creating a Python "
+    "integer for each.\n\n"
+    ":param left: Left end of the interval.\n"
+    ":param right: Right end of the interval. Must be greater than ``left``.\n"
+    ":param count: Number of integers to generate.\n\n"
+    ":return: Array (of type code ``'q'``) of uniform pseudorandom integers in the range ``left`` (inclusive) to "
+    "``right`` (exclusive).");
+PyDoc_STRVAR(real_many_doc,
+    "real_many(count) -> array.array\n"
+    "Generate cryptographically secure pseudorandom fractions in a single pass, without creating a Python float for "
+    "each.\n\n"
+    ":param count: Number of reals to generate.\n\n"
+    ":return: Array (of type code ``'d'``) of uniform pseudorandom reals in the range 0 (inclusive) to 1 "
+    "(inclusive).");
 PyDoc_STRVAR(drop_doc,
     "drop()\n"
     "Advance the state of the HDRBG object. Equivalent to running ``fill(0)`` ``count`` times and discarding the "
     "results.");
+PyDoc_STRVAR(stats_doc,
+    "stats() -> dict\n"
+    "Obtain the counters of the HDRBG object and the totals of the counters of all HDRBG objects in the process. "
+    "Raises ``RuntimeError`` unless statistics were enabled when compiling.\n\n"
+    ":return: Dictionary with keys ``'object'`` and ``'process'``, each of which maps to a dictionary with keys "
+    "``'requests'``, ``'bytes'``, ``'reseeds_interval'``, ``'reseeds_prediction_resistance'``, "
+    "``'reseeds_explicit'``, ``'reseeds_fork'``, ``'entropy_reads'`` and ``'entropy_ns'``.");
+PyDoc_STRVAR(hdrbg_reinit_doc,
+    "reinit()\n"
+    "Reinitialise (reseed) the HDRBG object.");
+PyDoc_STRVAR(hdrbg_type_doc,
+    "HDRBG()\n"
+    "HDRBG object with its own state, initialised (seeded) when created and zeroed when destroyed. It has the same "
+    "methods as this module. Different threads may use different HDRBG objects in parallel, because long requests "
+    "are fulfilled without holding the global interpreter lock.");
+PyDoc_STRVAR(random_seed_doc,
+    "seed(*args, **kwargs)\n"
+    "Do nothing. (The internal HDRBG object cannot be seeded with a chosen value.)");
+PyDoc_STRVAR(random_state_doc,
+    "Raise ``NotImplementedError``. (The state of the internal HDRBG object cannot be saved or restored.)");
+PyDoc_STRVAR(random_random_doc,
+    "random() -> float\n"
+    "Generate a cryptographically secure pseudorandom fraction.\n\n"
+    ":return: Uniform pseudorandom real in the range 0 (inclusive) to 1 (exclusive), a multiple of 2 ** −53.");
+PyDoc_STRVAR(random_getrandbits_doc,
+    "getrandbits(k) -> int\n"
+    "Generate a cryptographically secure pseudorandom number of the given width.\n\n"
+    ":param k: Number of bits. Must be non-negative.\n\n"
+    ":return: Uniform pseudorandom integer in the range 0 (inclusive) to 2 ** ``k`` (exclusive).");
+PyDoc_STRVAR(random_randbytes_doc,
+    "randbytes(n) -> bytes\n"
+    "Generate cryptographically secure pseudorandom bytes.\n\n"
+    ":param n: Number of bytes to generate. Must be non-negative.\n\n"
+    ":return: Uniform pseudorandom bytes object.");
+PyDoc_STRVAR(random_type_doc,
+    "Random()\n"
+    "Subclass of ``random.Random`` which uses the internal HDRBG object (of the calling thread) instead of the "
+    "Mersenne Twister, so that ``shuffle``, ``sample``, ``choices``, etc. are cryptographically secure. Like "
+    "``random.SystemRandom``, it ignores seeds and has no state which can be saved or restored.");
 PyDoc_STRVAR(pyhdrbg_doc,
     "Python API for a C implementation of Hash DRBG "
     "(see https://github.com/tfpf/hash-drbg/blob/main/doc for the full documentation)");
 static PyMethodDef pyhdrbg_methods[] = {
+    { "backend", Backend, METH_NOARGS, backend_doc },
     { "_init", Init, METH_NOARGS, init_doc },
     { "_reinit", Reinit, METH_NOARGS, reinit_doc },
     { "fill", Fill, METH_VARARGS, bytes_doc },
+    { "fill_into", FillInto, METH_VARARGS, fill_into_doc },
+    { "buffer", Buffer, METH_VARARGS, buffer_doc },
     { "rand", Rand, METH_NOARGS, rand_doc },
     { "uint", Uint, METH_VARARGS, uint_doc },
     { "span", Span, METH_VARARGS, span_doc },
     { "real", Real, METH_NOARGS, real_doc },
+    { "rand_many", RandMany, METH_VARARGS, rand_many_doc },
+    { "uint_many", UintMany, METH_VARARGS, uint_many_doc },
+    { "span_many", SpanMany, METH_VARARGS, span_many_doc },
+    { "real_many", RealMany, METH_VARARGS, real_many_doc },
     { "drop", Drop, METH_VARARGS, drop_doc },
+    { "stats", Stats, METH_NOARGS, stats_doc },
     { NULL, NULL, 0, NULL },
 };
+static PyMethodDef hdrbg_type_methods[] = {
+    { "reinit", Reinit, METH_NOARGS, hdrbg_reinit_doc },
+    { "fill", Fill, METH_VARARGS, bytes_doc },
+    { "fill_into", FillInto, METH_VARARGS, fill_into_doc },
+    { "buffer", Buffer, METH_VARARGS, buffer_doc },
+    { "rand", Rand, METH_NOARGS, rand_doc },
+    { "uint", Uint, METH_VARARGS, uint_doc },
+    { "span", Span, METH_VARARGS, span_doc },
+    { "real", Real, METH_NOARGS, real_doc },
+    { "rand_many", RandMany, METH_VARARGS, rand_many_doc },
+    { "uint_many", UintMany, METH_VARARGS, uint_many_doc },
+    { "span_many", SpanMany, METH_VARARGS, span_many_doc },
+    { "real_many", RealMany, METH_VARARGS, real_many_doc },
+    { "drop", Drop, METH_VARARGS, drop_doc },
+    { "stats", Stats, METH_NOARGS, stats_doc },
+    { NULL, NULL, 0, NULL },
+};
+static PyType_Slot hdrbg_type_slots[] = {
+    { Py_tp_doc, (void *)hdrbg_type_doc },
+    { Py_tp_new, HDRBGNew },
+    { Py_tp_dealloc, HDRBGDealloc },
+    { Py_tp_methods, hdrbg_type_methods },
+    { 0, NULL },
+};
+static PyType_Spec hdrbg_type_spec = {
+    "hdrbg.HDRBG",
+    sizeof(HDRBGObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    hdrbg_type_slots,
+};
+static PyMethodDef random_type_methods[] = {
+    { "seed", (PyCFunction)(void (*)(void))RandomSeed, METH_VARARGS | METH_KEYWORDS, random_seed_doc },
+    { "getstate", RandomState, METH_VARARGS, random_state_doc },
+    { "setstate", RandomState, METH_VARARGS, random_state_doc },
+    { "random", Real, METH_NOARGS, random_random_doc },
+    { "getrandbits", RandomGetrandbits, METH_VARARGS, random_getrandbits_doc },
+    { "randbytes", RandomRandbytes, METH_VARARGS, random_randbytes_doc },
+    { NULL, NULL, 0, NULL },
+};
+static PyType_Slot random_type_slots[] = {
+    { Py_tp_doc, (void *)random_type_doc },
+    { Py_tp_methods, random_type_methods },
+    { 0, NULL },
+};
+static PyType_Spec random_type_spec = {
+    "hdrbg.Random",
+    0,
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    random_type_slots,
+};
 static PyModuleDef pyhdrbg = {
     PyModuleDef_HEAD_INIT,
     "hdrbg",
@@ -246,13 +926,62 @@ PyInit_hdrbg(void)
         return NULL;
     }
 
+    PyObject *array_module = PyImport_ImportModule("array");
+    if (array_module == NULL)
+    {
+        return NULL;
+    }
+    ArrayType = PyObject_GetAttrString(array_module, "array");
+    Py_DECREF(array_module);
+    if (ArrayType == NULL)
+    {
+        return NULL;
+    }
+    PyObject *pyhdrbg_module = PyModule_Create(&pyhdrbg);
+    if (pyhdrbg_module == NULL)
+    {
+        return NULL;
+    }
+    HDRBGType = (PyTypeObject *)PyType_FromSpec(&hdrbg_type_spec);
+    if (HDRBGType == NULL)
+    {
+        return NULL;
+    }
+
+    // The module and this file each hold a reference to the type.
+    Py_INCREF(HDRBGType);
+    if (PyModule_AddObject(pyhdrbg_module, "HDRBG", (PyObject *)HDRBGType) < 0)
+    {
+        Py_DECREF(HDRBGType);
+        return NULL;
+    }
+
+    // Subclass `random.Random`.
+    PyObject *random_module = PyImport_ImportModule("random");
+    if (random_module == NULL)
+    {
+        return NULL;
+    }
+    PyObject *random_bases = Py_BuildValue("(N)", PyObject_GetAttrString(random_module, "Random"));
+    Py_DECREF(random_module);
+    if (random_bases == NULL)
+    {
+        return NULL;
+    }
+    PyObject *random_type = PyType_FromSpecWithBases(&random_type_spec, random_bases);
+    Py_DECREF(random_bases);
+    if (random_type == NULL || PyModule_AddObject(pyhdrbg_module, "Random", random_type) < 0)
+    {
+        Py_XDECREF(random_type);
+        return NULL;
+    }
+
     PyObject *ulong_max = PyLong_FromUnsignedLong(ULONG_MAX);
     PyObject *ullong_max = PyLong_FromUnsignedLongLong(ULLONG_MAX);
     PyObject *long_min = PyLong_FromLong(LONG_MIN);
     PyObject *long_max = PyLong_FromLong(LONG_MAX);
     PyObject *llong_min = PyLong_FromLongLong(LLONG_MIN);
     PyObject *llong_max = PyLong_FromLongLong(LLONG_MAX);
-    PyObject *pyhdrbg_module = PyModule_Create(&pyhdrbg);
     PyObject *pyhdrbg_dict = PyModule_GetDict(pyhdrbg_module);
     PyDict_SetItemString(pyhdrbg_dict, "ULONG_MAX", ulong_max);
     PyDict_SetItemString(pyhdrbg_dict, "ULLONG_MAX", ullong_max);
@@ -1,5 +1,6 @@
 #include <inttypes.h>
 #include <limits.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -10,6 +11,12 @@
 #include <openssl/sha.h>
 #endif
 
+#if (defined __x86_64__ || defined __i386__) && (defined __GNUC__ || defined __clang__)
+#define TFPF_HASH_DRBG_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 #define ROTR32(x, n) ((x) >> (n) | (x) << (32 - (n)))
 
 // Hash initialiser.
@@ -36,67 +43,64 @@ static uint32_t const sha256_rc[64] = {
 // Hash output.
 static uint8_t sha256_bytes[32];
 
+// Message schedules (with the round constants added) of the final chunks of
+// messages whose lengths are 56 to 63 bytes. Such a chunk contains only
+// padding, so it is the same for all messages of a given length.
+static uint32_t sha256_tail[8][64];
+
 /******************************************************************************
- * Calculate the hash of the given data.
- *
- * @param m_bytes_ Array of bytes representing the big-endian data to hash.
- * @param m_length_ Number of bytes to process.
- * @param h_bytes Array to store the bytes of the hash in, in big-endian order.
- *     (It must have sufficient space for 32 elements.) If `NULL`, the hash
- *     will be stored in a static array.
+ * Compress a 512-bit chunk whose message schedule has already been expanded,
+ * using only standard C.
  *
- * @return Array of bytes representing the big-endian hash of the data.
+ * @param h_words Intermediate hash. Updated in place.
+ * @param schedule Message schedule with the round constants added.
  *****************************************************************************/
-uint8_t *
-sha256(uint8_t const *m_bytes_, size_t m_length_, uint8_t *h_bytes)
+static inline void
+sha256_rounds_generic(uint32_t *h_words, uint32_t const *schedule)
 {
-#if defined TFPF_HASH_DRBG_OPENSSL_FOUND && CHAR_BIT == 8
-    return SHA256(m_bytes_, m_length_, h_bytes);
-#endif
-
-    // Initialise the hash.
-    uint32_t h_words[8];
-    memcpy(h_words, sha256_init, sizeof sha256_init);
-
-    // The amount of zero-padding required is odd, hence a non-zero number.
-    uint64_t nbits = (uint64_t)m_length_ << 3;
-    size_t zeros = 512 - ((nbits + 65) & 511U);
+    uint32_t curr[8];
+    memcpy(curr, h_words, sizeof curr);
+    for (int j = 0; j < 64; ++j)
+    {
+        uint32_t Sigma0 = ROTR32(curr[0], 2) ^ ROTR32(curr[0], 13) ^ ROTR32(curr[0], 22);
+        uint32_t Sigma1 = ROTR32(curr[4], 6) ^ ROTR32(curr[4], 11) ^ ROTR32(curr[4], 25);
+        uint32_t choice = (curr[4] & curr[5]) ^ (~curr[4] & curr[6]);
+        uint32_t major = (curr[0] & curr[1]) ^ (curr[1] & curr[2]) ^ (curr[2] & curr[0]);
+        uint32_t tmp = curr[7] + Sigma1 + choice + schedule[j];
+        curr[7] = curr[6];
+        curr[6] = curr[5];
+        curr[5] = curr[4];
+        curr[4] = curr[3] + tmp;
+        curr[3] = curr[2];
+        curr[2] = curr[1];
+        curr[1] = curr[0];
+        curr[0] = tmp + Sigma0 + major;
+    }
 
-    // Store the padding bytes in a sufficiently large array.
-    size_t p_length = ((1 + zeros) >> 3) + 8;
-    uint8_t p_bytes[72] = { 0x80U };
-    memdecompose(p_bytes + p_length - 8, 8, nbits);
+    // Calculate the intermediate hash.
+    for (int j = 0; j < 8; ++j)
+    {
+        h_words[j] += curr[j];
+    }
+}
 
-    // Process each 512-bit chunk.
-    uint8_t const *m_iter = m_bytes_;
-    size_t m_length = m_length_ + p_length;
-    for (size_t i = 0; i < m_length; i += 64)
+/******************************************************************************
+ * Process 512-bit chunks using only standard C.
+ *
+ * @param h_words Intermediate hash. Updated in place.
+ * @param m_bytes Array of bytes representing the big-endian data to process.
+ * @param blocks Number of 64-byte chunks to process.
+ *****************************************************************************/
+static void
+sha256_compress_generic(uint32_t *h_words, uint8_t const *m_bytes, size_t blocks)
+{
+    for (; blocks > 0; --blocks, m_bytes += 64)
     {
         // Expand to 2048 bits.
-        uint32_t schedule[64] = { 0 };
+        uint32_t schedule[64];
         for (int j = 0; j < 16; ++j)
         {
-            uint8_t const *m_iter_ = m_iter + 4;
-            if (m_iter < m_bytes_ + m_length_ && m_iter_ >= m_bytes_ + m_length_)
-            {
-                // Reading four bytes will cross the message-padding boundary.
-                // Switch over from message bytes to padding bytes.
-                int k;
-                for (k = 0; m_iter < m_bytes_ + m_length_; ++k, ++m_iter)
-                {
-                    schedule[j] = schedule[j] << 8 | *m_iter;
-                }
-                m_iter = p_bytes;
-                for (; k < 4; ++k, ++m_iter)
-                {
-                    schedule[j] = schedule[j] << 8 | *m_iter;
-                }
-            }
-            else
-            {
-                schedule[j] = memcompose(m_iter, 4);
-                m_iter = m_iter_;
-            }
+            schedule[j] = memcompose(m_bytes + 4 * j, 4);
         }
         for (int j = 16; j < 64; ++j)
         {
@@ -105,39 +109,667 @@ sha256(uint8_t const *m_bytes_, size_t m_length_, uint8_t *h_bytes)
             schedule[j] = schedule[j - 16] + schedule[j - 7] + sigma0 + sigma1;
         }
 
-        // Compress to 256 bits.
-        uint32_t curr[8];
-        memcpy(curr, h_words, sizeof curr);
         for (int j = 0; j < 64; ++j)
         {
-            uint32_t Sigma0 = ROTR32(curr[0], 2) ^ ROTR32(curr[0], 13) ^ ROTR32(curr[0], 22);
-            uint32_t Sigma1 = ROTR32(curr[4], 6) ^ ROTR32(curr[4], 11) ^ ROTR32(curr[4], 25);
-            uint32_t choice = (curr[4] & curr[5]) ^ (~curr[4] & curr[6]);
-            uint32_t major = (curr[0] & curr[1]) ^ (curr[1] & curr[2]) ^ (curr[2] & curr[0]);
-            uint32_t tmp = curr[7] + Sigma1 + choice + sha256_rc[j] + schedule[j];
-            curr[7] = curr[6];
-            curr[6] = curr[5];
-            curr[5] = curr[4];
-            curr[4] = curr[3] + tmp;
-            curr[3] = curr[2];
-            curr[2] = curr[1];
-            curr[1] = curr[0];
-            curr[0] = tmp + Sigma0 + major;
+            schedule[j] += sha256_rc[j];
         }
+        sha256_rounds_generic(h_words, schedule);
+    }
+}
+
+#ifdef TFPF_HASH_DRBG_X86
+#define SSE_ROTR32(x, n) _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - (n)))
+#define SSE_SIGMA0(x) _mm_xor_si128(_mm_xor_si128(SSE_ROTR32(x, 7), SSE_ROTR32(x, 18)), _mm_srli_epi32(x, 3))
+#define SSE_SIGMA1(x) _mm_xor_si128(_mm_xor_si128(SSE_ROTR32(x, 17), SSE_ROTR32(x, 19)), _mm_srli_epi32(x, 10))
 
-        // Calculate the intermediate hash.
+/******************************************************************************
+ * Process 512-bit chunks, expanding the message schedule four words at a time
+ * using SSSE3 instructions. The rounds are the same as those of the generic
+ * implementation.
+ *
+ * @param h_words Intermediate hash. Updated in place.
+ * @param m_bytes Array of bytes representing the big-endian data to process.
+ * @param blocks Number of 64-byte chunks to process.
+ *****************************************************************************/
+__attribute__((target("ssse3"))) static void
+sha256_compress_ssse3(uint32_t *h_words, uint8_t const *m_bytes, size_t blocks)
+{
+    __m128i const bswap = _mm_set_epi64x(0x0C0D0E0F08090A0BLL, 0x0405060700010203LL);
+    __m128i const upper = _mm_set_epi32(-1, -1, 0, 0);
+    for (; blocks > 0; --blocks, m_bytes += 64)
+    {
+        // Expand to 2048 bits, adding the round constants on the way.
+        uint32_t schedule[64];
+        __m128i w[4];
+        for (int j = 0; j < 4; ++j)
+        {
+            w[j] = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(m_bytes + 16 * j)), bswap);
+            __m128i k = _mm_loadu_si128((__m128i const *)(sha256_rc + 4 * j));
+            _mm_storeu_si128((__m128i *)(schedule + 4 * j), _mm_add_epi32(w[j], k));
+        }
+        for (int j = 4; j < 16; ++j)
+        {
+            // The first two words depend on the last two words of the
+            // previous group. The last two words depend on the first two.
+            __m128i w15 = _mm_alignr_epi8(w[1], w[0], 4);
+            __m128i w7 = _mm_alignr_epi8(w[3], w[2], 4);
+            __m128i next = _mm_add_epi32(_mm_add_epi32(w[0], w7), SSE_SIGMA0(w15));
+            __m128i w2 = _mm_shuffle_epi32(w[3], 0xFE);
+            next = _mm_add_epi32(next, _mm_move_epi64(SSE_SIGMA1(w2)));
+            w2 = _mm_shuffle_epi32(next, 0x40);
+            next = _mm_add_epi32(next, _mm_and_si128(SSE_SIGMA1(w2), upper));
+            w[0] = w[1];
+            w[1] = w[2];
+            w[2] = w[3];
+            w[3] = next;
+            __m128i k = _mm_loadu_si128((__m128i const *)(sha256_rc + 4 * j));
+            _mm_storeu_si128((__m128i *)(schedule + 4 * j), _mm_add_epi32(next, k));
+        }
+
+        sha256_rounds_generic(h_words, schedule);
+    }
+}
+
+// Four rounds using the SHA extensions. The message schedule words `cur` are
+// consumed; the next group of words is completed and the one after that is
+// started as soon as their inputs are available.
+#define SHA_NI_ROUNDS(i, prev, cur, next)                                                                             \
+    do                                                                                                                \
+    {                                                                                                                 \
+        __m128i msg = _mm_add_epi32(cur, _mm_loadu_si128((__m128i const *)(sha256_rc + 4 * (i))));                    \
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);                                                          \
+        if ((i) >= 3 && (i) <= 14)                                                                                    \
+        {                                                                                                             \
+            next = _mm_sha256msg2_epu32(_mm_add_epi32(next, _mm_alignr_epi8(cur, prev, 4)), cur);                     \
+        }                                                                                                             \
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));                                 \
+        if ((i) >= 1 && (i) <= 12)                                                                                    \
+        {                                                                                                             \
+            prev = _mm_sha256msg1_epu32(prev, cur);                                                                   \
+        }                                                                                                             \
+    } while (false)
+
+/******************************************************************************
+ * Process 512-bit chunks using the SHA extensions.
+ *
+ * @param h_words Intermediate hash. Updated in place.
+ * @param m_bytes Array of bytes representing the big-endian data to process.
+ * @param blocks Number of 64-byte chunks to process.
+ *****************************************************************************/
+__attribute__((target("sha,sse4.1"))) static void
+sha256_compress_shani(uint32_t *h_words, uint8_t const *m_bytes, size_t blocks)
+{
+    __m128i const bswap = _mm_set_epi64x(0x0C0D0E0F08090A0BLL, 0x0405060700010203LL);
+
+    // The instructions expect the working variables in the order ABEF and
+    // CDGH.
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const *)h_words), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const *)(h_words + 4)), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+    for (; blocks > 0; --blocks, m_bytes += 64)
+    {
+        __m128i state0_ = state0;
+        __m128i state1_ = state1;
+        __m128i w0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)m_bytes), bswap);
+        __m128i w1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(m_bytes + 16)), bswap);
+        __m128i w2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(m_bytes + 32)), bswap);
+        __m128i w3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(m_bytes + 48)), bswap);
+        SHA_NI_ROUNDS(0, w3, w0, w1);
+        SHA_NI_ROUNDS(1, w0, w1, w2);
+        SHA_NI_ROUNDS(2, w1, w2, w3);
+        SHA_NI_ROUNDS(3, w2, w3, w0);
+        SHA_NI_ROUNDS(4, w3, w0, w1);
+        SHA_NI_ROUNDS(5, w0, w1, w2);
+        SHA_NI_ROUNDS(6, w1, w2, w3);
+        SHA_NI_ROUNDS(7, w2, w3, w0);
+        SHA_NI_ROUNDS(8, w3, w0, w1);
+        SHA_NI_ROUNDS(9, w0, w1, w2);
+        SHA_NI_ROUNDS(10, w1, w2, w3);
+        SHA_NI_ROUNDS(11, w2, w3, w0);
+        SHA_NI_ROUNDS(12, w3, w0, w1);
+        SHA_NI_ROUNDS(13, w0, w1, w2);
+        SHA_NI_ROUNDS(14, w1, w2, w3);
+        SHA_NI_ROUNDS(15, w2, w3, w0);
+        state0 = _mm_add_epi32(state0, state0_);
+        state1 = _mm_add_epi32(state1, state1_);
+    }
+
+    // Restore the order ABCD and EFGH.
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128((__m128i *)h_words, _mm_blend_epi16(tmp, state1, 0xF0));
+    _mm_storeu_si128((__m128i *)(h_words + 4), _mm_alignr_epi8(state1, tmp, 8));
+}
+
+/******************************************************************************
+ * Compress a 512-bit chunk whose message schedule has already been expanded,
+ * using the SHA extensions.
+ *
+ * @param h_words Intermediate hash. Updated in place.
+ * @param schedule Message schedule with the round constants added.
+ *****************************************************************************/
+__attribute__((target("sha,sse4.1"))) static void
+sha256_rounds_shani(uint32_t *h_words, uint32_t const *schedule)
+{
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const *)h_words), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const *)(h_words + 4)), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+    __m128i state0_ = state0;
+    __m128i state1_ = state1;
+    for (int i = 0; i < 16; ++i)
+    {
+        __m128i msg = _mm_loadu_si128((__m128i const *)(schedule + 4 * i));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+    }
+    state0 = _mm_add_epi32(state0, state0_);
+    state1 = _mm_add_epi32(state1, state1_);
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128((__m128i *)h_words, _mm_blend_epi16(tmp, state1, 0xF0));
+    _mm_storeu_si128((__m128i *)(h_words + 4), _mm_alignr_epi8(state1, tmp, 8));
+}
+
+// Four rounds for each of two messages using the SHA extensions, interleaved
+// so that the instructions of one hide the latency of those of the other.
+#define SHA_NI_ROUNDS_X2(i, prev, cur, next)                                                                          \
+    do                                                                                                                \
+    {                                                                                                                 \
+        __m128i k = _mm_loadu_si128((__m128i const *)(sha256_rc + 4 * (i)));                                          \
+        __m128i msg0 = _mm_add_epi32(cur[0], k);                                                                      \
+        __m128i msg1 = _mm_add_epi32(cur[1], k);                                                                      \
+        state1[0] = _mm_sha256rnds2_epu32(state1[0], state0[0], msg0);                                                \
+        state1[1] = _mm_sha256rnds2_epu32(state1[1], state0[1], msg1);                                                \
+        if ((i) >= 3 && (i) <= 14)                                                                                    \
+        {                                                                                                             \
+            next[0] = _mm_sha256msg2_epu32(_mm_add_epi32(next[0], _mm_alignr_epi8(cur[0], prev[0], 4)), cur[0]);      \
+            next[1] = _mm_sha256msg2_epu32(_mm_add_epi32(next[1], _mm_alignr_epi8(cur[1], prev[1], 4)), cur[1]);      \
+        }                                                                                                             \
+        state0[0] = _mm_sha256rnds2_epu32(state0[0], state1[0], _mm_shuffle_epi32(msg0, 0x0E));                       \
+        state0[1] = _mm_sha256rnds2_epu32(state0[1], state1[1], _mm_shuffle_epi32(msg1, 0x0E));                       \
+        if ((i) >= 1 && (i) <= 12)                                                                                    \
+        {                                                                                                             \
+            prev[0] = _mm_sha256msg1_epu32(prev[0], cur[0]);                                                          \
+            prev[1] = _mm_sha256msg1_epu32(prev[1], cur[1]);                                                          \
+        }                                                                                                             \
+    } while (false)
+
+/******************************************************************************
+ * Calculate the hashes of two messages simultaneously using the SHA
+ * extensions. A single message does not keep the execution units busy,
+ * because each round depends on the previous one.
+ *
+ * @param p_bytes Array of two padded 512-bit chunks, one after the other.
+ * @param h_bytes Array to store the bytes of the hashes in, in big-endian
+ *     order, one after the other. (It must have sufficient space for 64
+ *     elements.)
+ *****************************************************************************/
+__attribute__((target("sha,sse4.1"))) static void
+sha256_multi_shani(uint8_t const *p_bytes, uint8_t *h_bytes)
+{
+    __m128i const bswap = _mm_set_epi64x(0x0C0D0E0F08090A0BLL, 0x0405060700010203LL);
+
+    // The instructions expect the working variables in the order ABEF and
+    // CDGH.
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const *)sha256_init), 0xB1);
+    __m128i init1 = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const *)(sha256_init + 4)), 0x1B);
+    __m128i init0 = _mm_alignr_epi8(tmp, init1, 8);
+    init1 = _mm_blend_epi16(init1, tmp, 0xF0);
+    __m128i state0[2] = { init0, init0 };
+    __m128i state1[2] = { init1, init1 };
+    __m128i w0[2], w1[2], w2[2], w3[2];
+    for (int l = 0; l < 2; ++l)
+    {
+        w0[l] = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(p_bytes + 64 * l)), bswap);
+        w1[l] = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(p_bytes + 64 * l + 16)), bswap);
+        w2[l] = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(p_bytes + 64 * l + 32)), bswap);
+        w3[l] = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(p_bytes + 64 * l + 48)), bswap);
+    }
+    SHA_NI_ROUNDS_X2(0, w3, w0, w1);
+    SHA_NI_ROUNDS_X2(1, w0, w1, w2);
+    SHA_NI_ROUNDS_X2(2, w1, w2, w3);
+    SHA_NI_ROUNDS_X2(3, w2, w3, w0);
+    SHA_NI_ROUNDS_X2(4, w3, w0, w1);
+    SHA_NI_ROUNDS_X2(5, w0, w1, w2);
+    SHA_NI_ROUNDS_X2(6, w1, w2, w3);
+    SHA_NI_ROUNDS_X2(7, w2, w3, w0);
+    SHA_NI_ROUNDS_X2(8, w3, w0, w1);
+    SHA_NI_ROUNDS_X2(9, w0, w1, w2);
+    SHA_NI_ROUNDS_X2(10, w1, w2, w3);
+    SHA_NI_ROUNDS_X2(11, w2, w3, w0);
+    SHA_NI_ROUNDS_X2(12, w3, w0, w1);
+    SHA_NI_ROUNDS_X2(13, w0, w1, w2);
+    SHA_NI_ROUNDS_X2(14, w1, w2, w3);
+    SHA_NI_ROUNDS_X2(15, w2, w3, w0);
+
+    // Restore the order ABCD and EFGH, and store the words in big-endian
+    // order.
+    for (int l = 0; l < 2; ++l)
+    {
+        tmp = _mm_shuffle_epi32(_mm_add_epi32(state0[l], init0), 0x1B);
+        __m128i h1 = _mm_shuffle_epi32(_mm_add_epi32(state1[l], init1), 0xB1);
+        __m128i h0 = _mm_blend_epi16(tmp, h1, 0xF0);
+        h1 = _mm_alignr_epi8(h1, tmp, 8);
+        _mm_storeu_si128((__m128i *)(h_bytes + 32 * l), _mm_shuffle_epi8(h0, bswap));
+        _mm_storeu_si128((__m128i *)(h_bytes + 32 * l + 16), _mm_shuffle_epi8(h1, bswap));
+    }
+}
+
+#define AVX2_ROTR32(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+
+/******************************************************************************
+ * Calculate the hashes of eight messages simultaneously using AVX2
+ * instructions, one message per 32-bit lane.
+ *
+ * @param p_bytes Array of eight padded 512-bit chunks, one after the other.
+ * @param h_bytes Array to store the bytes of the hashes in, in big-endian
+ *     order, one after the other. (It must have sufficient space for 256
+ *     elements.)
+ *****************************************************************************/
+__attribute__((target("avx2"))) static void
+sha256_multi_avx2(uint8_t const *p_bytes, uint8_t *h_bytes)
+{
+    __m256i const bswap = _mm256_set_epi64x(
+        0x0C0D0E0F08090A0BLL, 0x0405060700010203LL, 0x0C0D0E0F08090A0BLL, 0x0405060700010203LL);
+    __m256i const offsets = _mm256_setr_epi32(0, 64, 128, 192, 256, 320, 384, 448);
+    __m256i schedule[16];
+    for (int j = 0; j < 16; ++j)
+    {
+        __m256i w = _mm256_i32gather_epi32((int const *)(p_bytes + 4 * j), offsets, 1);
+        schedule[j] = _mm256_shuffle_epi8(w, bswap);
+    }
+    __m256i curr[8];
+    for (int j = 0; j < 8; ++j)
+    {
+        curr[j] = _mm256_set1_epi32(sha256_init[j]);
+    }
+    for (int j = 0; j < 64; ++j)
+    {
+        if (j >= 16)
+        {
+            __m256i w15 = schedule[(j - 15) & 15];
+            __m256i w2 = schedule[(j - 2) & 15];
+            __m256i sigma0 = AVX2_XOR3(AVX2_ROTR32(w15, 7), AVX2_ROTR32(w15, 18), _mm256_srli_epi32(w15, 3));
+            __m256i sigma1 = AVX2_XOR3(AVX2_ROTR32(w2, 17), AVX2_ROTR32(w2, 19), _mm256_srli_epi32(w2, 10));
+            __m256i w = _mm256_add_epi32(schedule[j & 15], schedule[(j - 7) & 15]);
+            schedule[j & 15] = _mm256_add_epi32(w, _mm256_add_epi32(sigma0, sigma1));
+        }
+        __m256i Sigma0 = AVX2_XOR3(AVX2_ROTR32(curr[0], 2), AVX2_ROTR32(curr[0], 13), AVX2_ROTR32(curr[0], 22));
+        __m256i Sigma1 = AVX2_XOR3(AVX2_ROTR32(curr[4], 6), AVX2_ROTR32(curr[4], 11), AVX2_ROTR32(curr[4], 25));
+        __m256i choice = _mm256_xor_si256(_mm256_and_si256(curr[4], curr[5]), _mm256_andnot_si256(curr[4], curr[6]));
+        __m256i major = _mm256_or_si256(
+            _mm256_and_si256(curr[0], curr[1]), _mm256_and_si256(curr[2], _mm256_or_si256(curr[0], curr[1])));
+        __m256i tmp = _mm256_add_epi32(_mm256_add_epi32(curr[7], Sigma1), _mm256_add_epi32(choice, schedule[j & 15]));
+        tmp = _mm256_add_epi32(tmp, _mm256_set1_epi32(sha256_rc[j]));
+        curr[7] = curr[6];
+        curr[6] = curr[5];
+        curr[5] = curr[4];
+        curr[4] = _mm256_add_epi32(curr[3], tmp);
+        curr[3] = curr[2];
+        curr[2] = curr[1];
+        curr[1] = curr[0];
+        curr[0] = _mm256_add_epi32(tmp, _mm256_add_epi32(Sigma0, major));
+    }
+
+    // Copy the hashes to the output array, lane by lane.
+    uint32_t h_words[8][8];
+    for (int j = 0; j < 8; ++j)
+    {
+        __m256i h = _mm256_add_epi32(curr[j], _mm256_set1_epi32(sha256_init[j]));
+        _mm256_storeu_si256((__m256i *)h_words[j], _mm256_shuffle_epi8(h, bswap));
+    }
+    for (int i = 0; i < 8; ++i)
+    {
         for (int j = 0; j < 8; ++j)
         {
-            h_words[j] += curr[j];
+            memcpy(h_bytes + 32 * i + 4 * j, &h_words[j][i], 4);
         }
     }
+}
 
-    // Copy the hash to the output array.
-    h_bytes = h_bytes == NULL ? sha256_bytes : h_bytes;
-    uint8_t *h_iter = h_bytes;
+#define AVX512_XOR3(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+
+/******************************************************************************
+ * Calculate the hashes of sixteen messages simultaneously using AVX-512
+ * instructions, one message per 32-bit lane.
+ *
+ * @param p_bytes Array of sixteen padded 512-bit chunks, one after the other.
+ * @param h_bytes Array to store the bytes of the hashes in, in big-endian
+ *     order, one after the other. (It must have sufficient space for 512
+ *     elements.)
+ *****************************************************************************/
+__attribute__((target("avx512f,avx512bw"))) static void
+sha256_multi_avx512(uint8_t const *p_bytes, uint8_t *h_bytes)
+{
+    __m512i const bswap = _mm512_set4_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203);
+    __m512i const offsets = _mm512_setr_epi32(0, 64, 128, 192, 256, 320, 384, 448, 512, 576, 640, 704, 768, 832,
+        896, 960);
+    __m512i schedule[16];
+    for (int j = 0; j < 16; ++j)
+    {
+        __m512i w = _mm512_i32gather_epi32(offsets, p_bytes + 4 * j, 1);
+        schedule[j] = _mm512_shuffle_epi8(w, bswap);
+    }
+    __m512i curr[8];
+    for (int j = 0; j < 8; ++j)
+    {
+        curr[j] = _mm512_set1_epi32(sha256_init[j]);
+    }
+    for (int j = 0; j < 64; ++j)
+    {
+        if (j >= 16)
+        {
+            __m512i w15 = schedule[(j - 15) & 15];
+            __m512i w2 = schedule[(j - 2) & 15];
+            __m512i sigma0
+                = AVX512_XOR3(_mm512_ror_epi32(w15, 7), _mm512_ror_epi32(w15, 18), _mm512_srli_epi32(w15, 3));
+            __m512i sigma1
+                = AVX512_XOR3(_mm512_ror_epi32(w2, 17), _mm512_ror_epi32(w2, 19), _mm512_srli_epi32(w2, 10));
+            __m512i w = _mm512_add_epi32(schedule[j & 15], schedule[(j - 7) & 15]);
+            schedule[j & 15] = _mm512_add_epi32(w, _mm512_add_epi32(sigma0, sigma1));
+        }
+        __m512i Sigma0
+            = AVX512_XOR3(_mm512_ror_epi32(curr[0], 2), _mm512_ror_epi32(curr[0], 13), _mm512_ror_epi32(curr[0], 22));
+        __m512i Sigma1
+            = AVX512_XOR3(_mm512_ror_epi32(curr[4], 6), _mm512_ror_epi32(curr[4], 11), _mm512_ror_epi32(curr[4], 25));
+        __m512i choice = _mm512_ternarylogic_epi32(curr[4], curr[5], curr[6], 0xCA);
+        __m512i major = _mm512_ternarylogic_epi32(curr[0], curr[1], curr[2], 0xE8);
+        __m512i tmp = _mm512_add_epi32(_mm512_add_epi32(curr[7], Sigma1), _mm512_add_epi32(choice, schedule[j & 15]));
+        tmp = _mm512_add_epi32(tmp, _mm512_set1_epi32(sha256_rc[j]));
+        curr[7] = curr[6];
+        curr[6] = curr[5];
+        curr[5] = curr[4];
+        curr[4] = _mm512_add_epi32(curr[3], tmp);
+        curr[3] = curr[2];
+        curr[2] = curr[1];
+        curr[1] = curr[0];
+        curr[0] = _mm512_add_epi32(tmp, _mm512_add_epi32(Sigma0, major));
+    }
+
+    // Copy the hashes to the output array, lane by lane.
+    __m512i const h_offsets = _mm512_srli_epi32(offsets, 1);
+    for (int j = 0; j < 8; ++j)
+    {
+        __m512i h = _mm512_add_epi32(curr[j], _mm512_set1_epi32(sha256_init[j]));
+        _mm512_i32scatter_epi32(h_bytes + 4 * j, h_offsets, _mm512_shuffle_epi8(h, bswap), 1);
+    }
+}
+#endif
+
+// Implementation selected when the library is loaded.
+static void (*sha256_compress)(uint32_t *h_words, uint8_t const *m_bytes, size_t blocks) = sha256_compress_generic;
+static void (*sha256_rounds)(uint32_t *h_words, uint32_t const *schedule) = sha256_rounds_generic;
+static char const *sha256_name = "generic";
+#if defined TFPF_HASH_DRBG_OPENSSL_FOUND && CHAR_BIT == 8
+static bool sha256_openssl = false;
+#endif
+
+// Multi-buffer implementations selected when the library is loaded, if any.
+static void (*sha256_multi_x2)(uint8_t const *p_bytes, uint8_t *h_bytes) = NULL;
+static void (*sha256_multi_x8)(uint8_t const *p_bytes, uint8_t *h_bytes) = NULL;
+static void (*sha256_multi_x16)(uint8_t const *p_bytes, uint8_t *h_bytes) = NULL;
+
+/******************************************************************************
+ * Select the fastest implementations supported by the processor. The SHA
+ * extensions are preferred over everything else. OpenSSL (if found) is
+ * preferred over the remaining implementations. For multi-buffer hashing, two
+ * interleaved messages using the SHA extensions beat eight AVX2 lanes, but not
+ * sixteen AVX-512 lanes.
+ *****************************************************************************/
+__attribute__((constructor)) static void
+sha256_select(void)
+{
+#ifdef TFPF_HASH_DRBG_X86
+    int unsigned eax, ebx, ecx, edx;
+    bool ssse3 = false, sse41 = false, osxsave = false, sha = false, avx2 = false, avx512 = false;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        ssse3 = ecx >> 9 & 1;
+        sse41 = ecx >> 19 & 1;
+        osxsave = ecx >> 27 & 1;
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    {
+        sha = ebx >> 29 & 1;
+        avx2 = ebx >> 5 & 1;
+        avx512 = (ebx >> 16 & 1) && (ebx >> 30 & 1);
+    }
+
+    // The wide registers are usable only if the operating system saves them
+    // on context switches.
+    int unsigned xcr0 = 0;
+    if (osxsave)
+    {
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        xcr0 = eax;
+    }
+    if (avx2 && (xcr0 & 0x06U) == 0x06U)
+    {
+        sha256_multi_x8 = sha256_multi_avx2;
+    }
+    if (avx512 && (xcr0 & 0xE6U) == 0xE6U)
+    {
+        sha256_multi_x16 = sha256_multi_avx512;
+    }
+
+    if (sha && sse41)
+    {
+        sha256_compress = sha256_compress_shani;
+        sha256_rounds = sha256_rounds_shani;
+        sha256_name = "sha-ni";
+        sha256_multi_x2 = sha256_multi_shani;
+        sha256_multi_x8 = NULL;
+        return;
+    }
+#endif
+#if defined TFPF_HASH_DRBG_OPENSSL_FOUND && CHAR_BIT == 8
+    sha256_openssl = true;
+    sha256_name = "openssl";
+    return;
+#endif
+#ifdef TFPF_HASH_DRBG_X86
+    if (ssse3)
+    {
+        sha256_compress = sha256_compress_ssse3;
+        sha256_name = "ssse3";
+    }
+#endif
+}
+
+/******************************************************************************
+ * Expand the message schedules of the final chunks which contain only padding.
+ *****************************************************************************/
+__attribute__((constructor)) static void
+sha256_precompute(void)
+{
     for (int i = 0; i < 8; ++i)
     {
-        h_iter += memdecompose(h_iter, 4, h_words[i]);
+        uint8_t p_bytes[64] = { 0 };
+        memdecompose(p_bytes + 56, 8, (uint64_t)(56 + i) << 3);
+        uint32_t *schedule = sha256_tail[i];
+        for (int j = 0; j < 16; ++j)
+        {
+            schedule[j] = memcompose(p_bytes + 4 * j, 4);
+        }
+        for (int j = 16; j < 64; ++j)
+        {
+            uint32_t sigma0 = ROTR32(schedule[j - 15], 7) ^ ROTR32(schedule[j - 15], 18) ^ schedule[j - 15] >> 3;
+            uint32_t sigma1 = ROTR32(schedule[j - 2], 17) ^ ROTR32(schedule[j - 2], 19) ^ schedule[j - 2] >> 10;
+            schedule[j] = schedule[j - 16] + schedule[j - 7] + sigma0 + sigma1;
+        }
+        for (int j = 0; j < 64; ++j)
+        {
+            schedule[j] += sha256_rc[j];
+        }
+    }
+}
+
+/******************************************************************************
+ * Obtain the name of the implementation in use.
+ *
+ * @return One of "sha-ni", "openssl", "ssse3" and "generic".
+ *****************************************************************************/
+char const *
+sha256_backend(void)
+{
+    return sha256_name;
+}
+
+/******************************************************************************
+ * Convert the final intermediate hash into bytes.
+ *
+ * @param h_words Intermediate hash.
+ * @param h_bytes Array to store the bytes of the hash in, in big-endian order.
+ *     (It must have sufficient space for 32 elements.)
+ *****************************************************************************/
+static void
+sha256_digest(uint32_t const *h_words, uint8_t *h_bytes)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        h_bytes += memdecompose(h_bytes, 4, h_words[i]);
+    }
+}
+
+/******************************************************************************
+ * Calculate the hash of the given data.
+ *
+ * @param m_bytes Array of bytes representing the big-endian data to hash.
+ * @param m_length Number of bytes to process.
+ * @param h_bytes Array to store the bytes of the hash in, in big-endian order.
+ *     (It must have sufficient space for 32 elements.) If `NULL`, the hash
+ *     will be stored in a static array.
+ *
+ * @return Array of bytes representing the big-endian hash of the data.
+ *****************************************************************************/
+uint8_t *
+sha256(uint8_t const *m_bytes, size_t m_length, uint8_t *h_bytes)
+{
+#if defined TFPF_HASH_DRBG_OPENSSL_FOUND && CHAR_BIT == 8
+    if (sha256_openssl)
+    {
+        return SHA256(m_bytes, m_length, h_bytes);
     }
+#endif
+
+    // Initialise the hash.
+    uint32_t h_words[8];
+    memcpy(h_words, sha256_init, sizeof sha256_init);
+
+    // Process all complete 512-bit chunks in place.
+    size_t blocks = m_length >> 6;
+    sha256_compress(h_words, m_bytes, blocks);
+
+    // Copy the remaining bytes and the padding to another chunk. The amount of
+    // zero-padding required is odd, hence a non-zero number; whence there is
+    // always at least one more chunk to process.
+    size_t r_length = m_length & 63U;
+    uint8_t p_bytes[64];
+    memcpy(p_bytes, m_bytes + (blocks << 6), r_length * sizeof *p_bytes);
+    p_bytes[r_length] = 0x80U;
+    memset(p_bytes + r_length + 1, 0, (63 - r_length) * sizeof *p_bytes);
+    if (r_length < 56)
+    {
+        memdecompose(p_bytes + 56, 8, (uint64_t)m_length << 3);
+        sha256_compress(h_words, p_bytes, 1);
+    }
+    else if (m_length < 64)
+    {
+        // The last chunk contains only padding, and its message schedule has
+        // already been expanded.
+        sha256_compress(h_words, p_bytes, 1);
+        sha256_rounds(h_words, sha256_tail[m_length - 56]);
+    }
+    else
+    {
+        sha256_compress(h_words, p_bytes, 1);
+        memset(p_bytes, 0, 56 * sizeof *p_bytes);
+        memdecompose(p_bytes + 56, 8, (uint64_t)m_length << 3);
+        sha256_compress(h_words, p_bytes, 1);
+    }
+
+    // Copy the hash to the output array.
+    h_bytes = h_bytes == NULL ? sha256_bytes : h_bytes;
+    sha256_digest(h_words, h_bytes);
     return h_bytes;
 }
+
+/******************************************************************************
+ * Calculate the hashes of several messages of the same length, each of which
+ * fits in a single 512-bit chunk after padding. If a multi-buffer
+ * implementation is available, several messages are hashed simultaneously.
+ *
+ * @param m_bytes Array of bytes representing the big-endian messages to hash,
+ *     one after the other.
+ * @param m_length Number of bytes of each message. At most 55.
+ * @param count Number of messages. At most `SHA256_MULTI_LIMIT`.
+ * @param h_bytes Array to store the bytes of the hashes in, in big-endian
+ *     order, one after the other. (It must have sufficient space for
+ *     `32 * count` elements.)
+ *****************************************************************************/
+void
+sha256_multi(uint8_t const *m_bytes, size_t m_length, size_t count, uint8_t *h_bytes)
+{
+    // Pad each message.
+    uint8_t p_bytes[SHA256_MULTI_LIMIT][64];
+    for (size_t i = 0; i < count; ++i)
+    {
+        memcpy(p_bytes[i], m_bytes + i * m_length, m_length * sizeof *m_bytes);
+        p_bytes[i][m_length] = 0x80U;
+        memset(p_bytes[i] + m_length + 1, 0, (55 - m_length) * sizeof *p_bytes[i]);
+        memdecompose(p_bytes[i] + 56, 8, (uint64_t)m_length << 3);
+    }
+
+    // A partially-filled multi-buffer pass is still faster than hashing the
+    // messages one by one, unless most of the lanes would be idle. The idle
+    // lanes hash zeros. If the SHA extensions are available, hashing two
+    // messages at a time with them is faster unless few lanes would be idle.
+    size_t i = 0;
+    if (sha256_multi_x16 != NULL && count > (sha256_multi_x2 != NULL ? 11 : 8))
+    {
+        memset(p_bytes[count], 0, (SHA256_MULTI_LIMIT - count) * sizeof *p_bytes);
+        uint8_t tmp[SHA256_MULTI_LIMIT][32];
+        sha256_multi_x16(p_bytes[0], tmp[0]);
+        memcpy(h_bytes, tmp, count * sizeof *tmp);
+        return;
+    }
+    if (sha256_multi_x8 != NULL)
+    {
+        for (; count - i >= 8; i += 8)
+        {
+            sha256_multi_x8(p_bytes[i], h_bytes + 32 * i);
+        }
+        if (count - i > 6)
+        {
+            memset(p_bytes[count], 0, (i + 8 - count) * sizeof *p_bytes);
+            uint8_t tmp[8][32];
+            sha256_multi_x8(p_bytes[i], tmp[0]);
+            memcpy(h_bytes + 32 * i, tmp, (count - i) * sizeof *tmp);
+            return;
+        }
+    }
+    if (sha256_multi_x2 != NULL)
+    {
+        for (; count - i >= 2; i += 2)
+        {
+            sha256_multi_x2(p_bytes[i], h_bytes + 32 * i);
+        }
+    }
+    for (; i < count; ++i)
+    {
+#if defined TFPF_HASH_DRBG_OPENSSL_FOUND && CHAR_BIT == 8
+        if (sha256_openssl)
+        {
+            SHA256(m_bytes + i * m_length, m_length, h_bytes + 32 * i);
+            continue;
+        }
+#endif
+        uint32_t h_words[8];
+        memcpy(h_words, sha256_init, sizeof sha256_init);
+        sha256_compress(h_words, p_bytes[i], 1);
+        sha256_digest(h_words, h_bytes + 32 * i);
+    }
+}
@@ -0,0 +1,412 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "extras.h"
+#include "sha.h"
+
+#if (defined __x86_64__ || defined __i386__) && (defined __GNUC__ || defined __clang__)
+#define TFPF_HASH_DRBG_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#define ROTR64(x, n) ((x) >> (n) | (x) << (64 - (n)))
+
+// Hash initialiser.
+static uint64_t const sha512_init[8] = {
+    // clang-format off
+    0x6A09E667F3BCC908U, 0xBB67AE8584CAA73BU, 0x3C6EF372FE94F82BU, 0xA54FF53A5F1D36F1U,
+    0x510E527FADE682D1U, 0x9B05688C2B3E6C1FU, 0x1F83D9ABFB41BD6BU, 0x5BE0CD19137E2179U,
+    // clang-format on
+};
+
+// Round constants.
+static uint64_t const sha512_rc[80] = {
+    // clang-format off
+    0x428A2F98D728AE22U, 0x7137449123EF65CDU, 0xB5C0FBCFEC4D3B2FU, 0xE9B5DBA58189DBBCU,
+    0x3956C25BF348B538U, 0x59F111F1B605D019U, 0x923F82A4AF194F9BU, 0xAB1C5ED5DA6D8118U,
+    0xD807AA98A3030242U, 0x12835B0145706FBEU, 0x243185BE4EE4B28CU, 0x550C7DC3D5FFB4E2U,
+    0x72BE5D74F27B896FU, 0x80DEB1FE3B1696B1U, 0x9BDC06A725C71235U, 0xC19BF174CF692694U,
+    0xE49B69C19EF14AD2U, 0xEFBE4786384F25E3U, 0x0FC19DC68B8CD5B5U, 0x240CA1CC77AC9C65U,
+    0x2DE92C6F592B0275U, 0x4A7484AA6EA6E483U, 0x5CB0A9DCBD41FBD4U, 0x76F988DA831153B5U,
+    0x983E5152EE66DFABU, 0xA831C66D2DB43210U, 0xB00327C898FB213FU, 0xBF597FC7BEEF0EE4U,
+    0xC6E00BF33DA88FC2U, 0xD5A79147930AA725U, 0x06CA6351E003826FU, 0x142929670A0E6E70U,
+    0x27B70A8546D22FFCU, 0x2E1B21385C26C926U, 0x4D2C6DFC5AC42AEDU, 0x53380D139D95B3DFU,
+    0x650A73548BAF63DEU, 0x766A0ABB3C77B2A8U, 0x81C2C92E47EDAEE6U, 0x92722C851482353BU,
+    0xA2BFE8A14CF10364U, 0xA81A664BBC423001U, 0xC24B8B70D0F89791U, 0xC76C51A30654BE30U,
+    0xD192E819D6EF5218U, 0xD69906245565A910U, 0xF40E35855771202AU, 0x106AA07032BBD1B8U,
+    0x19A4C116B8D2D0C8U, 0x1E376C085141AB53U, 0x2748774CDF8EEB99U, 0x34B0BCB5E19B48A8U,
+    0x391C0CB3C5C95A63U, 0x4ED8AA4AE3418ACBU, 0x5B9CCA4F7763E373U, 0x682E6FF3D6B2B8A3U,
+    0x748F82EE5DEFB2FCU, 0x78A5636F43172F60U, 0x84C87814A1F0AB72U, 0x8CC702081A6439ECU,
+    0x90BEFFFA23631E28U, 0xA4506CEBDE82BDE9U, 0xBEF9A3F7B2C67915U, 0xC67178F2E372532BU,
+    0xCA273ECEEA26619CU, 0xD186B8C721C0C207U, 0xEADA7DD6CDE0EB1EU, 0xF57D4F7FEE6ED178U,
+    0x06F067AA72176FBAU, 0x0A637DC5A2C898A6U, 0x113F9804BEF90DAEU, 0x1B710B35131C471BU,
+    0x28DB77F523047D84U, 0x32CAAB7B40C72493U, 0x3C9EBE0A15C9BEBCU, 0x431D67C49C100D4CU,
+    0x4CC5D4BECB3E42B6U, 0x597F299CFC657E2AU, 0x5FCB6FAB3AD6FAECU, 0x6C44198C4A475817U,
+    // clang-format on
+};
+
+// Hash output.
+static uint8_t sha512_bytes[64];
+
+/******************************************************************************
+ * Process 1024-bit chunks using only standard C.
+ *
+ * @param h_words Intermediate hash. Updated in place.
+ * @param m_bytes Array of bytes representing the big-endian data to process.
+ * @param blocks Number of 128-byte chunks to process.
+ *****************************************************************************/
+static void
+sha512_compress(uint64_t *h_words, uint8_t const *m_bytes, size_t blocks)
+{
+    for (; blocks > 0; --blocks, m_bytes += 128)
+    {
+        // Expand to 5120 bits.
+        uint64_t schedule[80];
+        for (int j = 0; j < 16; ++j)
+        {
+            schedule[j] = memcompose(m_bytes + 8 * j, 8);
+        }
+        for (int j = 16; j < 80; ++j)
+        {
+            uint64_t sigma0 = ROTR64(schedule[j - 15], 1) ^ ROTR64(schedule[j - 15], 8) ^ schedule[j - 15] >> 7;
+            uint64_t sigma1 = ROTR64(schedule[j - 2], 19) ^ ROTR64(schedule[j - 2], 61) ^ schedule[j - 2] >> 6;
+            schedule[j] = schedule[j - 16] + schedule[j - 7] + sigma0 + sigma1;
+        }
+
+        uint64_t curr[8];
+        memcpy(curr, h_words, sizeof curr);
+        for (int j = 0; j < 80; ++j)
+        {
+            uint64_t Sigma0 = ROTR64(curr[0], 28) ^ ROTR64(curr[0], 34) ^ ROTR64(curr[0], 39);
+            uint64_t Sigma1 = ROTR64(curr[4], 14) ^ ROTR64(curr[4], 18) ^ ROTR64(curr[4], 41);
+            uint64_t choice = (curr[4] & curr[5]) ^ (~curr[4] & curr[6]);
+            uint64_t major = (curr[0] & curr[1]) ^ (curr[1] & curr[2]) ^ (curr[2] & curr[0]);
+            uint64_t tmp = curr[7] + Sigma1 + choice + sha512_rc[j] + schedule[j];
+            curr[7] = curr[6];
+            curr[6] = curr[5];
+            curr[5] = curr[4];
+            curr[4] = curr[3] + tmp;
+            curr[3] = curr[2];
+            curr[2] = curr[1];
+            curr[1] = curr[0];
+            curr[0] = tmp + Sigma0 + major;
+        }
+
+        // Calculate the intermediate hash.
+        for (int j = 0; j < 8; ++j)
+        {
+            h_words[j] += curr[j];
+        }
+    }
+}
+
+#ifdef TFPF_HASH_DRBG_X86
+#define AVX2_ROTR64(x, n) _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+#define AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+
+/******************************************************************************
+ * Calculate the hashes of four messages simultaneously using AVX2
+ * instructions, one message per 64-bit lane.
+ *
+ * @param p_bytes Array of four padded 1024-bit chunks, one after the other.
+ * @param h_bytes Array to store the bytes of the hashes in, in big-endian
+ *     order, one after the other. (It must have sufficient space for 256
+ *     elements.)
+ *****************************************************************************/
+__attribute__((target("avx2"))) static void
+sha512_multi_avx2(uint8_t const *p_bytes, uint8_t *h_bytes)
+{
+    __m256i const bswap = _mm256_set_epi64x(
+        0x08090A0B0C0D0E0FLL, 0x0001020304050607LL, 0x08090A0B0C0D0E0FLL, 0x0001020304050607LL);
+    __m256i const offsets = _mm256_setr_epi64x(0, 128, 256, 384);
+    __m256i schedule[16];
+    for (int j = 0; j < 16; ++j)
+    {
+        __m256i w = _mm256_i64gather_epi64((long long const *)(p_bytes + 8 * j), offsets, 1);
+        schedule[j] = _mm256_shuffle_epi8(w, bswap);
+    }
+    __m256i curr[8];
+    for (int j = 0; j < 8; ++j)
+    {
+        curr[j] = _mm256_set1_epi64x(sha512_init[j]);
+    }
+    for (int j = 0; j < 80; ++j)
+    {
+        if (j >= 16)
+        {
+            __m256i w15 = schedule[(j - 15) & 15];
+            __m256i w2 = schedule[(j - 2) & 15];
+            __m256i sigma0 = AVX2_XOR3(AVX2_ROTR64(w15, 1), AVX2_ROTR64(w15, 8), _mm256_srli_epi64(w15, 7));
+            __m256i sigma1 = AVX2_XOR3(AVX2_ROTR64(w2, 19), AVX2_ROTR64(w2, 61), _mm256_srli_epi64(w2, 6));
+            __m256i w = _mm256_add_epi64(schedule[j & 15], schedule[(j - 7) & 15]);
+            schedule[j & 15] = _mm256_add_epi64(w, _mm256_add_epi64(sigma0, sigma1));
+        }
+        __m256i Sigma0 = AVX2_XOR3(AVX2_ROTR64(curr[0], 28), AVX2_ROTR64(curr[0], 34), AVX2_ROTR64(curr[0], 39));
+        __m256i Sigma1 = AVX2_XOR3(AVX2_ROTR64(curr[4], 14), AVX2_ROTR64(curr[4], 18), AVX2_ROTR64(curr[4], 41));
+        __m256i choice = _mm256_xor_si256(_mm256_and_si256(curr[4], curr[5]), _mm256_andnot_si256(curr[4], curr[6]));
+        __m256i major = _mm256_or_si256(
+            _mm256_and_si256(curr[0], curr[1]), _mm256_and_si256(curr[2], _mm256_or_si256(curr[0], curr[1])));
+        __m256i tmp = _mm256_add_epi64(_mm256_add_epi64(curr[7], Sigma1), _mm256_add_epi64(choice, schedule[j & 15]));
+        tmp = _mm256_add_epi64(tmp, _mm256_set1_epi64x(sha512_rc[j]));
+        curr[7] = curr[6];
+        curr[6] = curr[5];
+        curr[5] = curr[4];
+        curr[4] = _mm256_add_epi64(curr[3], tmp);
+        curr[3] = curr[2];
+        curr[2] = curr[1];
+        curr[1] = curr[0];
+        curr[0] = _mm256_add_epi64(tmp, _mm256_add_epi64(Sigma0, major));
+    }
+
+    // Copy the hashes to the output array, lane by lane.
+    uint64_t h_words[8][4];
+    for (int j = 0; j < 8; ++j)
+    {
+        __m256i h = _mm256_add_epi64(curr[j], _mm256_set1_epi64x(sha512_init[j]));
+        _mm256_storeu_si256((__m256i *)h_words[j], _mm256_shuffle_epi8(h, bswap));
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            memcpy(h_bytes + 64 * i + 8 * j, &h_words[j][i], 8);
+        }
+    }
+}
+
+#define AVX512_XOR3(x, y, z) _mm512_ternarylogic_epi64(x, y, z, 0x96)
+
+/******************************************************************************
+ * Calculate the hashes of eight messages simultaneously using AVX-512
+ * instructions, one message per 64-bit lane.
+ *
+ * @param p_bytes Array of eight padded 1024-bit chunks, one after the other.
+ * @param h_bytes Array to store the bytes of the hashes in, in big-endian
+ *     order, one after the other. (It must have sufficient space for 512
+ *     elements.)
+ *****************************************************************************/
+__attribute__((target("avx512f,avx512bw"))) static void
+sha512_multi_avx512(uint8_t const *p_bytes, uint8_t *h_bytes)
+{
+    __m512i const bswap = _mm512_set4_epi64(
+        0x08090A0B0C0D0E0FLL, 0x0001020304050607LL, 0x08090A0B0C0D0E0FLL, 0x0001020304050607LL);
+    __m512i const offsets = _mm512_setr_epi64(0, 128, 256, 384, 512, 640, 768, 896);
+    __m512i schedule[16];
+    for (int j = 0; j < 16; ++j)
+    {
+        __m512i w = _mm512_i64gather_epi64(offsets, p_bytes + 8 * j, 1);
+        schedule[j] = _mm512_shuffle_epi8(w, bswap);
+    }
+    __m512i curr[8];
+    for (int j = 0; j < 8; ++j)
+    {
+        curr[j] = _mm512_set1_epi64(sha512_init[j]);
+    }
+    for (int j = 0; j < 80; ++j)
+    {
+        if (j >= 16)
+        {
+            __m512i w15 = schedule[(j - 15) & 15];
+            __m512i w2 = schedule[(j - 2) & 15];
+            __m512i sigma0
+                = AVX512_XOR3(_mm512_ror_epi64(w15, 1), _mm512_ror_epi64(w15, 8), _mm512_srli_epi64(w15, 7));
+            __m512i sigma1
+                = AVX512_XOR3(_mm512_ror_epi64(w2, 19), _mm512_ror_epi64(w2, 61), _mm512_srli_epi64(w2, 6));
+            __m512i w = _mm512_add_epi64(schedule[j & 15], schedule[(j - 7) & 15]);
+            schedule[j & 15] = _mm512_add_epi64(w, _mm512_add_epi64(sigma0, sigma1));
+        }
+        __m512i Sigma0 = AVX512_XOR3(
+            _mm512_ror_epi64(curr[0], 28), _mm512_ror_epi64(curr[0], 34), _mm512_ror_epi64(curr[0], 39));
+        __m512i Sigma1 = AVX512_XOR3(
+            _mm512_ror_epi64(curr[4], 14), _mm512_ror_epi64(curr[4], 18), _mm512_ror_epi64(curr[4], 41));
+        __m512i choice = _mm512_ternarylogic_epi64(curr[4], curr[5], curr[6], 0xCA);
+        __m512i major = _mm512_ternarylogic_epi64(curr[0], curr[1], curr[2], 0xE8);
+        __m512i tmp = _mm512_add_epi64(_mm512_add_epi64(curr[7], Sigma1), _mm512_add_epi64(choice, schedule[j & 15]));
+        tmp = _mm512_add_epi64(tmp, _mm512_set1_epi64(sha512_rc[j]));
+        curr[7] = curr[6];
+        curr[6] = curr[5];
+        curr[5] = curr[4];
+        curr[4] = _mm512_add_epi64(curr[3], tmp);
+        curr[3] = curr[2];
+        curr[2] = curr[1];
+        curr[1] = curr[0];
+        curr[0] = _mm512_add_epi64(tmp, _mm512_add_epi64(Sigma0, major));
+    }
+
+    // Copy the hashes to the output array, lane by lane.
+    __m512i const h_offsets = _mm512_srli_epi64(offsets, 1);
+    for (int j = 0; j < 8; ++j)
+    {
+        __m512i h = _mm512_add_epi64(curr[j], _mm512_set1_epi64(sha512_init[j]));
+        _mm512_i64scatter_epi64(h_bytes + 8 * j, h_offsets, _mm512_shuffle_epi8(h, bswap), 1);
+    }
+}
+#endif
+
+// Multi-buffer implementations selected when the library is loaded, if any.
+static void (*sha512_multi_x4)(uint8_t const *p_bytes, uint8_t *h_bytes) = NULL;
+static void (*sha512_multi_x8)(uint8_t const *p_bytes, uint8_t *h_bytes) = NULL;
+
+/******************************************************************************
+ * Select the multi-buffer implementations supported by the processor.
+ *****************************************************************************/
+__attribute__((constructor)) static void
+sha512_select(void)
+{
+#ifdef TFPF_HASH_DRBG_X86
+    int unsigned eax, ebx, ecx, edx;
+    bool osxsave = false, avx2 = false, avx512 = false;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        osxsave = ecx >> 27 & 1;
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    {
+        avx2 = ebx >> 5 & 1;
+        avx512 = (ebx >> 16 & 1) && (ebx >> 30 & 1);
+    }
+
+    // The wide registers are usable only if the operating system saves them
+    // on context switches.
+    int unsigned xcr0 = 0;
+    if (osxsave)
+    {
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        xcr0 = eax;
+    }
+    if (avx2 && (xcr0 & 0x06U) == 0x06U)
+    {
+        sha512_multi_x4 = sha512_multi_avx2;
+    }
+    if (avx512 && (xcr0 & 0xE6U) == 0xE6U)
+    {
+        sha512_multi_x8 = sha512_multi_avx512;
+    }
+#endif
+}
+
+/******************************************************************************
+ * Convert the final intermediate hash into bytes.
+ *
+ * @param h_words Intermediate hash.
+ * @param h_bytes Array to store the bytes of the hash in, in big-endian order.
+ *     (It must have sufficient space for 64 elements.)
+ *****************************************************************************/
+static void
+sha512_digest(uint64_t const *h_words, uint8_t *h_bytes)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        h_bytes += memdecompose(h_bytes, 8, h_words[i]);
+    }
+}
+
+/******************************************************************************
+ * Calculate the hash of the given data.
+ *
+ * @param m_bytes Array of bytes representing the big-endian data to hash.
+ * @param m_length Number of bytes to process.
+ * @param h_bytes Array to store the bytes of the hash in, in big-endian order.
+ *     (It must have sufficient space for 64 elements.) If `NULL`, the hash
+ *     will be stored in a static array.
+ *
+ * @return Array of bytes representing the big-endian hash of the data.
+ *****************************************************************************/
+uint8_t *
+sha512(uint8_t const *m_bytes, size_t m_length, uint8_t *h_bytes)
+{
+    h_bytes = h_bytes == NULL ? sha512_bytes : h_bytes;
+    // Initialise the hash.
+    uint64_t h_words[8];
+    memcpy(h_words, sha512_init, sizeof sha512_init);
+
+    // Process all complete 1024-bit chunks in place.
+    size_t blocks = m_length >> 7;
+    sha512_compress(h_words, m_bytes, blocks);
+
+    // Copy the remaining bytes and the padding to one or two more chunks. The
+    // length is stored in 128 bits, of which the upper 64 are always zero.
+    size_t r_length = m_length & 127U;
+    uint8_t p_bytes[256] = { 0 };
+    memcpy(p_bytes, m_bytes + (blocks << 7), r_length * sizeof *p_bytes);
+    p_bytes[r_length] = 0x80U;
+    size_t p_blocks = r_length < 112 ? 1 : 2;
+    memdecompose(p_bytes + 128 * p_blocks - 8, 8, (uint64_t)m_length << 3);
+    sha512_compress(h_words, p_bytes, p_blocks);
+
+    // Copy the hash to the output array.
+    sha512_digest(h_words, h_bytes);
+    return h_bytes;
+}
+
+/******************************************************************************
+ * Calculate the hashes of several messages of the same length, each of which
+ * fits in a single 1024-bit chunk after padding. If a multi-buffer
+ * implementation is available, several messages are hashed simultaneously.
+ *
+ * @param m_bytes Array of bytes representing the big-endian messages to hash,
+ *     one after the other.
+ * @param m_length Number of bytes of each message. At most 111.
+ * @param count Number of messages. At most `SHA512_MULTI_LIMIT`.
+ * @param h_bytes Array to store the bytes of the hashes in, in big-endian
+ *     order, one after the other. (It must have sufficient space for
+ *     `64 * count` elements.)
+ *****************************************************************************/
+void
+sha512_multi(uint8_t const *m_bytes, size_t m_length, size_t count, uint8_t *h_bytes)
+{
+    // Pad each message. The length is stored in 128 bits, of which the upper
+    // 64 are always zero.
+    uint8_t p_bytes[SHA512_MULTI_LIMIT][128];
+    for (size_t i = 0; i < count; ++i)
+    {
+        memcpy(p_bytes[i], m_bytes + i * m_length, m_length * sizeof *m_bytes);
+        p_bytes[i][m_length] = 0x80U;
+        memset(p_bytes[i] + m_length + 1, 0, (119 - m_length) * sizeof *p_bytes[i]);
+        memdecompose(p_bytes[i] + 120, 8, (uint64_t)m_length << 3);
+    }
+
+    // As in `sha256_multi`, a partially-filled multi-buffer pass is used
+    // unless most of the lanes would be idle. The idle lanes hash zeros.
+    size_t i = 0;
+    if (sha512_multi_x8 != NULL)
+    {
+        for (; count - i >= 8; i += 8)
+        {
+            sha512_multi_x8(p_bytes[i], h_bytes + 64 * i);
+        }
+        if (count - i > 4)
+        {
+            memset(p_bytes[count], 0, (i + 8 - count) * sizeof *p_bytes);
+            uint8_t tmp[8][64];
+            sha512_multi_x8(p_bytes[i], tmp[0]);
+            memcpy(h_bytes + 64 * i, tmp, (count - i) * sizeof *tmp);
+            return;
+        }
+    }
+    if (sha512_multi_x4 != NULL)
+    {
+        for (; count - i >= 4; i += 4)
+        {
+            sha512_multi_x4(p_bytes[i], h_bytes + 64 * i);
+        }
+        if (count - i > 2)
+        {
+            memset(p_bytes[count], 0, (i + 4 - count) * sizeof *p_bytes);
+            uint8_t tmp[4][64];
+            sha512_multi_x4(p_bytes[i], tmp[0]);
+            memcpy(h_bytes + 64 * i, tmp, (count - i) * sizeof *tmp);
+            return;
+        }
+    }
+    for (; i < count; ++i)
+    {
+        uint64_t h_words[8];
+        memcpy(h_words, sha512_init, sizeof sha512_init);
+        sha512_compress(h_words, p_bytes[i], 1);
+        sha512_digest(h_words, h_bytes + 64 * i);
+    }
+}
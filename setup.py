@@ -1,10 +1,16 @@
+import os
+
 from setuptools import Extension, setup
 
+# Set HDRBG_STATS to a non-empty value to enable the counters.
+define_macros = [("TFPF_HASH_DRBG_STATS", "1")] if os.environ.get("HDRBG_STATS") else []
+
 ext_modules = [
     Extension(
         name="hdrbg",
-        sources=["lib/pyhdrbg.c", "lib/hdrbg.c", "lib/sha256.c", "lib/extras.c"],
+        sources=["lib/pyhdrbg.c", "lib/hdrbg.c", "lib/entropy.c", "lib/sha256.c", "lib/sha512.c", "lib/extras.c"],
         include_dirs=["include"],
+        define_macros=define_macros,
         py_limited_api=True,
     )
 ]
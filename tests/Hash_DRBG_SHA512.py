@@ -0,0 +1,113 @@
+#! /usr/bin/env python3
+
+"""
+Generate the test vectors for Hash_DRBG with SHA-512 (Hash_DRBG_SHA512.dat),
+in the same format as those for Hash_DRBG with SHA-256 (Hash_DRBG.dat). The
+entropy input and nonces are derived deterministically from a label, so that
+running this script again produces the same file.
+
+This is a separate implementation written directly from NIST SP 800-90A. With
+the hash function set to SHA-256 and the seed length to 55 bytes, it
+reproduces Hash_DRBG.dat, which is checked before anything is written.
+"""
+
+import hashlib
+import os
+import sys
+
+
+class HashDRBG:
+    def __init__(self, name, seed_length, seed_material):
+        self.name = name
+        self.output_length = hashlib.new(name).digest_size
+        self.seed_length = seed_length
+        self.seed(seed_material)
+
+    def hash(self, message):
+        return hashlib.new(self.name, message).digest()
+
+    def hash_df(self, message, length):
+        output = b""
+        counter = 1
+        while len(output) < length:
+            output += self.hash(bytes([counter]) + (8 * length).to_bytes(4, "big") + message)
+            counter += 1
+        return output[:length]
+
+    def seed(self, seed_material):
+        self.V = self.hash_df(seed_material, self.seed_length)
+        self.C = self.hash_df(b"\x00" + self.V, self.seed_length)
+        self.reseed_counter = 1
+
+    def reseed(self, entropy):
+        self.seed(b"\x01" + self.V + entropy)
+
+    def add(self, *numbers):
+        total = sum(int.from_bytes(n, "big") if isinstance(n, bytes) else n for n in numbers)
+        return (total % (1 << 8 * self.seed_length)).to_bytes(self.seed_length, "big")
+
+    def generate(self, length):
+        output = b""
+        data = self.V
+        while len(output) < length:
+            output += self.hash(data)
+            data = self.add(data, 1)
+        self.V = self.add(self.V, self.hash(b"\x03" + self.V), self.C, self.reseed_counter)
+        self.reseed_counter += 1
+        return output[:length]
+
+
+def tests(name, seed_length, read, check):
+    """
+    Run 60 tests without prediction resistance followed by 60 tests with
+    prediction resistance. Obtain the entropy input and nonces by calling
+    `read`, and pass the output of each test to `check`.
+    """
+    for prediction_resistance in (False, True):
+        for _ in range(60):
+            drbg = HashDRBG(name, seed_length, read(48))
+            drbg.reseed(read(32))
+            drbg.generate(4 * drbg.output_length)
+            if prediction_resistance:
+                drbg.reseed(read(32))
+            check(drbg.generate(4 * drbg.output_length))
+
+
+def main():
+    directory = os.path.dirname(os.path.abspath(__file__))
+    with open(os.path.join(directory, "Hash_DRBG.dat"), "rb") as reader:
+        official = reader.read()
+    position = 0
+    mismatches = 0
+
+    def read_official(length):
+        nonlocal position
+        position += length
+        return official[position - length : position]
+
+    def check_official(output):
+        nonlocal mismatches
+        mismatches += output != read_official(len(output))
+
+    tests("sha256", 55, read_official, check_official)
+    if mismatches > 0 or official[position:] != b"\n":
+        sys.exit("this implementation does not reproduce Hash_DRBG.dat")
+
+    generated = bytearray()
+    counter = 0
+
+    def read_generated(length):
+        nonlocal counter
+        label = b"Hash_DRBG SHA-512 test vectors" + counter.to_bytes(4, "big")
+        counter += 1
+        generated.extend(hashlib.shake_256(label).digest(length))
+        return generated[-length:]
+
+    tests("sha512", 111, read_generated, generated.extend)
+    generated.extend(b"\n")
+    with open(os.path.join(directory, "Hash_DRBG_SHA512.dat"), "wb") as writer:
+        writer.write(generated)
+
+
+if __name__ == "__main__":
+    main()
@@ -4,6 +4,14 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined __unix__ || defined __APPLE__
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 // The C compilers available on the macOS runners on GitHub Actions do not
 // indicate their lack of support for standard threads with the expected
@@ -39,6 +47,21 @@ hdrbg_tests_custom(void *hd_)
         assert(hdrbg_uint(hd, 0) == UINT64_MAX);
         assert(hdrbg_err_get() == HDRBG_ERR_INVALID_REQUEST_UINT);
         assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+        uint32_t r32 = r >> 32;
+        if (r32 > 0)
+        {
+            assert(hdrbg_uint32(hd, r32) < r32);
+            assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+        }
+        assert(hdrbg_uint32(hd, 0) == UINT32_MAX);
+        assert(hdrbg_err_get() == HDRBG_ERR_INVALID_REQUEST_UINT);
+        double d = hdrbg_double(hd);
+        assert(0.0 <= d && d < 1.0);
+        d = hdrbg_double_open(hd);
+        assert(0.0 < d && d < 1.0);
+        float f = hdrbg_float(hd);
+        assert(0.0F <= f && f < 1.0F);
+        assert(hdrbg_err_get() == HDRBG_ERR_NONE);
     }
     for (int long i = 0; i < CUSTOM_ITERATIONS; ++i)
     {
@@ -61,9 +84,139 @@ hdrbg_tests_custom(void *hd_)
     assert(hdrbg_fill(hd, false, NULL, 65537UL) == -1);
     assert(hdrbg_err_get() == HDRBG_ERR_INVALID_REQUEST_FILL);
     assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+    uint64_t *r = malloc(CUSTOM_ITERATIONS * sizeof *r);
+    assert(hdrbg_rand_array(hd, r, CUSTOM_ITERATIONS) == 0);
+    for (int long i = 0; i < CUSTOM_ITERATIONS; i += 2)
+    {
+        uint64_t modulus = r[i] >> (r[i + 1] & 63);
+        if (modulus > 0)
+        {
+            uint64_t residues[3];
+            assert(hdrbg_uint_array(hd, modulus, residues, 3) == 0);
+            assert(residues[0] < modulus && residues[1] < modulus && residues[2] < modulus);
+        }
+    }
+    assert(hdrbg_uint_array(hd, 3, r, CUSTOM_ITERATIONS) == 0);
+    for (int long i = 0; i < CUSTOM_ITERATIONS; ++i)
+    {
+        assert(r[i] < 3);
+    }
+    assert(hdrbg_uint_array(hd, 0, r, 1) == -1);
+    assert(hdrbg_err_get() == HDRBG_ERR_INVALID_REQUEST_UINT);
+    int64_t *middles = (int64_t *)r;
+    assert(hdrbg_span_array(hd, -5, 5, middles, CUSTOM_ITERATIONS) == 0);
+    for (int long i = 0; i < CUSTOM_ITERATIONS; ++i)
+    {
+        assert(-5 <= middles[i] && middles[i] < 5);
+    }
+    assert(hdrbg_span_array(hd, 5, 5, middles, 1) == -1);
+    assert(hdrbg_err_get() == HDRBG_ERR_INVALID_REQUEST_SPAN);
+    double *reals = (double *)r;
+    assert(hdrbg_real_array(hd, reals, CUSTOM_ITERATIONS) == 0);
+    for (int long i = 0; i < CUSTOM_ITERATIONS; ++i)
+    {
+        assert(0.0 <= reals[i] && reals[i] <= 1.0);
+    }
+    assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+    assert(hdrbg_rand_array(hd, r, SIZE_MAX / 8 + 1) == -1);
+    assert(hdrbg_err_get() == HDRBG_ERR_INVALID_REQUEST_FILL);
+    assert(hdrbg_uint_array(hd, 3, r, SIZE_MAX / 8 + 1) == -1);
+    assert(hdrbg_err_get() == HDRBG_ERR_INVALID_REQUEST_FILL);
+    assert(hdrbg_real_array(hd, reals, SIZE_MAX / 8 + 1) == -1);
+    assert(hdrbg_err_get() == HDRBG_ERR_INVALID_REQUEST_FILL);
+    free(r);
+    uint8_t *r_bytes = malloc(3 * 65536UL + 1);
+    assert(hdrbg_fill_stream(hd, false, r_bytes, 3 * 65536UL + 1) == 0);
+    assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+    assert(hdrbg_fill_parallel(hd, false, r_bytes, 3 * 65536UL + 1, 4) == 0);
+    assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+#if defined __unix__ || defined __APPLE__
+    struct iovec iov[] = {
+        { .iov_base = r_bytes, .iov_len = 16 },
+        { .iov_base = r_bytes + 16, .iov_len = 4 },
+        { .iov_base = r_bytes + 20, .iov_len = 65536 },
+    };
+    assert(hdrbg_fillv(hd, false, iov, 2) == 0);
+    assert(hdrbg_fillv(hd, false, iov, 3) == -1);
+    assert(hdrbg_err_get() == HDRBG_ERR_INVALID_REQUEST_FILL);
+    assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+#endif
+    free(r_bytes);
+    return 0;
+}
+
+/******************************************************************************
+ * Repeatedly take an HDRBG object from a pool, use it and return it.
+ *
+ * @param pool_ Pool.
+ *
+ * @return Ignored.
+ *****************************************************************************/
+int
+hdrbg_tests_pool(void *pool_)
+{
+    struct hdrbg_pool_t *pool = pool_;
+    for (int long i = 0; i < CUSTOM_ITERATIONS; ++i)
+    {
+        struct hdrbg_t *hd = hdrbg_pool_acquire(pool);
+        if (hd == NULL)
+        {
+            assert(hdrbg_err_get() == HDRBG_ERR_POOL_EMPTY);
+            continue;
+        }
+        uint64_t r = hdrbg_rand(hd);
+        if (r > 0)
+        {
+            assert(hdrbg_uint(hd, r) < r);
+        }
+        hdrbg_pool_release(pool, hd);
+        assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Repeatedly reinitialise an HDRBG object and obtain prefetching statistics.
+ *
+ * @param hd_ HDRBG object.
+ *
+ * @return Ignored.
+ *****************************************************************************/
+int
+hdrbg_tests_prefetch(void *hd_)
+{
+    struct hdrbg_t *hd = hd_;
+    for (int i = 0; i < 1024; ++i)
+    {
+        assert(hdrbg_reinit(hd) == hd);
+        struct hdrbg_prefetch_stats_t stats;
+        hdrbg_prefetch_stats(&stats);
+        assert(stats.available <= stats.depth);
+    }
     return 0;
 }
 
+/******************************************************************************
+ * Entropy source which provides a limited number of zero bytes.
+ *
+ * @param ctx Number of bytes to provide per call.
+ * @param e_bytes
+ * @param e_length
+ *
+ * @return Number of bytes stored.
+ *****************************************************************************/
+size_t
+entropy_limited(void *ctx, uint8_t *e_bytes, size_t e_length)
+{
+    size_t limit = *(size_t *)ctx;
+    size_t len = e_length < limit ? e_length : limit;
+    for (size_t i = 0; i < len; ++i)
+    {
+        e_bytes[i] = 0;
+    }
+    return len;
+}
+
 /******************************************************************************
  * Main function.
  *****************************************************************************/
@@ -78,6 +231,7 @@ main(void)
         hds[i] = hdrbg_init(true);
         hdrbg_tests(hds[i], tv);
         rewind(tv);
+        hdrbg_buffer(hds[i], i & 1);
     }
 #ifndef STDC_NO_THREADS
     thrd_t workers[WORKERS_SIZE];
@@ -99,10 +253,291 @@ main(void)
     }
     printf("All tests passed.\n");
 
+    printf("Testing an HDRBG object using SHA-512.\n");
+    FILE *tv_sha512 = fopen("Hash_DRBG_SHA512.dat", "rb");
+    struct hdrbg_t *hd_sha512 = hdrbg_init_ex(HDRBG_HASH_SHA512);
+    assert(hd_sha512 != NULL);
+    hdrbg_tests(hd_sha512, tv_sha512);
+    fclose(tv_sha512);
+    hdrbg_tests_custom(hd_sha512);
+    hdrbg_buffer(hd_sha512, true);
+    hdrbg_tests_custom(hd_sha512);
+    hdrbg_zero(hd_sha512);
+    assert(hdrbg_init_ex(-1) == NULL);
+    assert(hdrbg_err_get() == HDRBG_ERR_INVALID_HASH);
+    printf("All tests passed.\n");
+
     printf("Testing the internal HDRBG object.\n");
     rewind(tv);
     hdrbg_tests(NULL, tv);
     hdrbg_tests_custom(NULL);
+    hdrbg_buffer(NULL, true);
+    hdrbg_tests_custom(NULL);
     fclose(tv);
+#ifndef STDC_NO_THREADS
+    // Each thread has its own internal HDRBG object, initialised on first use.
+    for (int i = 0; i < WORKERS_SIZE; ++i)
+    {
+        thrd_create(workers + i, hdrbg_tests_custom, NULL);
+    }
+    for (int i = 0; i < WORKERS_SIZE; ++i)
+    {
+        thrd_join(workers[i], NULL);
+    }
+#endif
     printf("All tests passed.\n");
+
+    printf("Testing a pool of HDRBG objects.\n");
+    struct hdrbg_pool_t *pool = hdrbg_pool_create(WORKERS_SIZE / 2);
+    struct hdrbg_t *pool_hds[WORKERS_SIZE / 2];
+    for (int i = 0; i < WORKERS_SIZE / 2; ++i)
+    {
+        pool_hds[i] = hdrbg_pool_acquire(pool);
+        assert(pool_hds[i] != NULL);
+    }
+    assert(hdrbg_pool_acquire(pool) == NULL);
+    assert(hdrbg_err_get() == HDRBG_ERR_POOL_EMPTY);
+    for (int i = 0; i < WORKERS_SIZE / 2; ++i)
+    {
+        hdrbg_pool_release(pool, pool_hds[i]);
+    }
+    for (int i = 0; i < WORKERS_SIZE; ++i)
+    {
+#ifndef STDC_NO_THREADS
+        thrd_create(workers + i, hdrbg_tests_pool, pool);
+#else
+        hdrbg_tests_pool(pool);
+#endif
+    }
+#ifndef STDC_NO_THREADS
+    for (int i = 0; i < WORKERS_SIZE; ++i)
+    {
+        thrd_join(workers[i], NULL);
+    }
+#endif
+    hdrbg_pool_zero(pool);
+    printf("All tests passed.\n");
+
+    printf("Testing a custom entropy source.\n");
+    size_t limit = 0;
+    hdrbg_set_entropy_source(entropy_limited, &limit);
+    assert(hdrbg_init(true) == NULL);
+    assert(hdrbg_err_get() == HDRBG_ERR_NO_ENTROPY);
+    limit = 16;
+    assert(hdrbg_init(true) == NULL);
+    assert(hdrbg_err_get() == HDRBG_ERR_INSUFFICIENT_ENTROPY);
+    limit = SIZE_MAX;
+    struct hdrbg_t *hd = hdrbg_init(true);
+    assert(hd != NULL);
+    assert(hdrbg_fill(hd, true, NULL, 0) == 0);
+    limit = 0;
+    assert(hdrbg_fill(hd, true, NULL, 0) == -1);
+    assert(hdrbg_err_get() == HDRBG_ERR_NO_ENTROPY);
+    hdrbg_zero(hd);
+    hdrbg_set_entropy_source(NULL, NULL);
+    hd = hdrbg_init(true);
+    assert(hd != NULL);
+    hdrbg_zero(hd);
+    assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+    printf("All tests passed.\n");
+
+    printf("Testing batch initialisation.\n");
+    struct hdrbg_t *many_hds[WORKERS_SIZE * 3];
+    size_t many_size = sizeof many_hds / sizeof *many_hds;
+    assert(hdrbg_init_many(many_hds, 0) == 0);
+    assert(hdrbg_init_many(many_hds, many_size) == 0);
+    uint8_t many_bytes[WORKERS_SIZE * 3][32];
+    for (int round = 0; round < 2; ++round)
+    {
+        for (size_t i = 0; i < many_size; ++i)
+        {
+            assert(hdrbg_fill(many_hds[i], false, many_bytes[i], sizeof many_bytes[i]) == 0);
+            for (size_t j = 0; j < i; ++j)
+            {
+                assert(memcmp(many_bytes[i], many_bytes[j], sizeof many_bytes[i]) != 0);
+            }
+        }
+        assert(hdrbg_reinit_many(many_hds, many_size) == 0);
+    }
+    hdrbg_tests_custom(many_hds[many_size - 1]);
+    struct hdrbg_stats_t many_stats;
+    if (hdrbg_stats_get(many_hds[0], &many_stats) == 0)
+    {
+        assert(many_stats.object.entropy_reads == 3 && many_stats.object.reseeds_explicit == 2);
+    }
+    limit = many_size * 32 - 1;
+    hdrbg_set_entropy_source(entropy_limited, &limit);
+    assert(hdrbg_reinit_many(many_hds, many_size) == -1);
+    assert(hdrbg_err_get() == HDRBG_ERR_INSUFFICIENT_ENTROPY);
+    for (size_t i = 0; i < many_size; ++i)
+    {
+        hdrbg_zero(many_hds[i]);
+    }
+    assert(hdrbg_init_many(many_hds, many_size) == -1);
+    assert(hdrbg_err_get() == HDRBG_ERR_INSUFFICIENT_ENTROPY);
+    for (size_t i = 0; i < many_size; ++i)
+    {
+        assert(many_hds[i] == NULL);
+    }
+    hdrbg_set_entropy_source(NULL, NULL);
+    printf("All tests passed.\n");
+
+#ifndef STDC_NO_THREADS
+    printf("Testing entropy prefetching.\n");
+    assert(hdrbg_prefetch_start(4) == 0);
+    struct hdrbg_prefetch_stats_t stats;
+    do
+    {
+        thrd_yield();
+        hdrbg_prefetch_stats(&stats);
+    } while (stats.available < 4);
+    assert(stats.depth == 4 && stats.hits == 0);
+    hd = hdrbg_init(true);
+    for (int i = 0; i < WORKERS_SIZE; ++i)
+    {
+        assert(hdrbg_reinit(hd) == hd);
+    }
+    hdrbg_prefetch_stats(&stats);
+    assert(stats.hits + stats.misses == WORKERS_SIZE + 1);
+    assert(stats.hits >= 4);
+
+    // The entropy source may be changed while the helper thread reads it.
+    limit = SIZE_MAX;
+    hdrbg_set_entropy_source(entropy_limited, &limit);
+    assert(hdrbg_reinit(hd) == hd);
+    hdrbg_set_entropy_source(NULL, NULL);
+    hdrbg_prefetch_stop();
+
+    // Prefetching may be restarted and stopped while other threads use it.
+    struct hdrbg_t *prefetch_hds[WORKERS_SIZE];
+    for (int i = 0; i < WORKERS_SIZE; ++i)
+    {
+        prefetch_hds[i] = hdrbg_init(true);
+        thrd_create(workers + i, hdrbg_tests_prefetch, prefetch_hds[i]);
+    }
+    for (int i = 0; i < 64; ++i)
+    {
+        assert(hdrbg_prefetch_start(1 + i % 4) == 0);
+    }
+    hdrbg_prefetch_stop();
+    for (int i = 0; i < WORKERS_SIZE; ++i)
+    {
+        thrd_join(workers[i], NULL);
+        hdrbg_zero(prefetch_hds[i]);
+    }
+    hdrbg_prefetch_stats(&stats);
+    assert(stats.depth == 0);
+    assert(hdrbg_reinit(hd) == hd);
+    hdrbg_zero(hd);
+    assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+    printf("All tests passed.\n");
+#endif
+
+    printf("Testing statistics.\n");
+    hd = hdrbg_init(true);
+    struct hdrbg_stats_t hd_stats;
+    if (hdrbg_stats_get(hd, &hd_stats) == 0)
+    {
+        assert(hd_stats.object.requests == 0 && hd_stats.object.entropy_reads == 1);
+        uint8_t r_bytes[65537];
+        assert(hdrbg_fill(hd, false, r_bytes, 100) == 0);
+        assert(hdrbg_fill(hd, true, NULL, 0) == 0);
+        assert(hdrbg_reinit(hd) == hd);
+        assert(hdrbg_fill_stream(hd, false, r_bytes, sizeof r_bytes) == 0);
+        assert(hdrbg_stats_get(hd, &hd_stats) == 0);
+        assert(hd_stats.object.requests == 4 && hd_stats.object.bytes == 100 + sizeof r_bytes);
+        assert(hd_stats.object.reseeds_prediction_resistance == 1 && hd_stats.object.reseeds_explicit == 1);
+        assert(hd_stats.object.reseeds_interval == 0 && hd_stats.object.entropy_reads == 3);
+        assert(hd_stats.process.requests >= hd_stats.object.requests);
+        assert(hd_stats.process.entropy_ns >= hd_stats.object.entropy_ns);
+    }
+    else
+    {
+        assert(hdrbg_err_get() == HDRBG_ERR_NO_STATS);
+    }
+    hdrbg_zero(hd);
+    assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+    printf("All tests passed.\n");
+
+#if defined __unix__ || defined __APPLE__
+    printf("Testing forking.\n");
+    hd = hdrbg_init(true);
+    hdrbg_buffer(NULL, true);
+    hdrbg_rand(NULL);
+#ifndef STDC_NO_THREADS
+    // Both processes reseed `hd` using entropy inputs obtained in advance,
+    // which must not be the same ones.
+    assert(hdrbg_prefetch_start(4) == 0);
+    do
+    {
+        thrd_yield();
+        hdrbg_prefetch_stats(&stats);
+    } while (stats.available < 4);
+#endif
+    int fds[2];
+    assert(pipe(fds) == 0);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    uint64_t fork_r[4];
+    assert(hdrbg_fill(hd, true, (uint8_t *)fork_r, 8) == 0);
+    fork_r[1] = hdrbg_rand(NULL);
+    assert(hdrbg_fill(hd, false, (uint8_t *)(fork_r + 2), 8) == 0);
+    assert(hdrbg_fill(NULL, false, (uint8_t *)(fork_r + 3), 8) == 0);
+    if (pid == 0)
+    {
+        if (hdrbg_stats_get(hd, &hd_stats) == 0)
+        {
+            assert(hd_stats.object.reseeds_prediction_resistance == 1 && hd_stats.object.reseeds_fork == 0);
+            assert(hdrbg_stats_get(NULL, &hd_stats) == 0 && hd_stats.object.reseeds_fork == 1);
+        }
+        hdrbg_err_get();
+        ssize_t written = write(fds[1], fork_r, sizeof fork_r);
+        _exit(written == sizeof fork_r ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    uint64_t fork_r_child[4];
+    assert(read(fds[0], fork_r_child, sizeof fork_r_child) == sizeof fork_r_child);
+    int status;
+    assert(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    for (int i = 0; i < 4; ++i)
+    {
+        assert(fork_r[i] != fork_r_child[i]);
+    }
+    close(fds[0]);
+    close(fds[1]);
+    hdrbg_prefetch_stop();
+    hdrbg_zero(hd);
+    assert(hdrbg_err_get() == HDRBG_ERR_NONE);
+#ifndef STDC_NO_THREADS
+    // Fork while other threads are using the entropy ring. The child process
+    // must be able to start and stop prefetching, even though those threads
+    // do not exist in it. (If it hangs instead, the alarm kills it.)
+    assert(hdrbg_prefetch_start(4) == 0);
+    for (int i = 0; i < WORKERS_SIZE; ++i)
+    {
+        prefetch_hds[i] = hdrbg_init(true);
+        thrd_create(workers + i, hdrbg_tests_prefetch, prefetch_hds[i]);
+    }
+    for (int i = 0; i < 32; ++i)
+    {
+        pid = fork();
+        assert(pid >= 0);
+        if (pid == 0)
+        {
+            alarm(10);
+            int started = hdrbg_prefetch_start(2);
+            hdrbg_prefetch_stop();
+            hdrbg_prefetch_stop();
+            _exit(started == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        assert(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    }
+    for (int i = 0; i < WORKERS_SIZE; ++i)
+    {
+        thrd_join(workers[i], NULL);
+        hdrbg_zero(prefetch_hds[i]);
+    }
+    hdrbg_prefetch_stop();
+#endif
+    printf("All tests passed.\n");
+#endif
 }